@@ -91,10 +91,16 @@ namespace
     int  regrid_on_restart;
     int  use_efficient_regrid;
     bool refine_grid_layout;
+    bool distributed_clustering;
+    bool async_output;
     int  plotfile_on_restart;
     int  checkpoint_on_restart;
     bool checkpoint_files_output;
     int  compute_new_dt_on_regrid;
+    //
+    // (temporary, final) names of asynchronously written output files.
+    //
+    std::vector< std::pair<std::string,std::string> > async_renames;
 }
 
 void
@@ -114,6 +120,8 @@ Amr::Initialize ()
     regrid_on_restart        = 0;
     use_efficient_regrid     = 0;
     refine_grid_layout       = true;
+    distributed_clustering   = false;
+    async_output             = false;
     plotfile_on_restart      = 0;
     checkpoint_on_restart    = 0;
     checkpoint_files_output  = true;
@@ -289,6 +297,16 @@ Amr::InitAmr (int max_level_in, Array<int> n_cell_in)
 
     pp.query("refine_grid_layout", refine_grid_layout);
 
+    pp.query("distributed_clustering", distributed_clustering);
+
+    pp.query("async_output", async_output);
+
+    {
+        int pooled_state_data = StateData::Pooled();
+        pp.query("pooled_state_data", pooled_state_data);
+        StateData::SetPooled(pooled_state_data);
+    }
+
     pp.query("mffile_nstreams", mffile_nstreams);
     pp.query("probinit_natonce", probinit_natonce);
 
@@ -655,6 +673,18 @@ Amr::InitAmr (int max_level_in, Array<int> n_cell_in)
     rebalance_grids = 0;
     pp.query("rebalance_grids", rebalance_grids);
 
+    use_measured_cost = false;
+    pp.query("use_measured_cost", use_measured_cost);
+
+    rebalance_threshold = 0;
+    pp.query("rebalance_threshold", rebalance_threshold);
+    //
+    // Checking the imbalance takes a reduction of the costs over the CPUs,
+    // so by default it's only done as often as level 0 regrids.
+    //
+    rebalance_int = (max_level > 0) ? regrid_int[0] : 1;
+    pp.query("rebalance_int", rebalance_int);
+
 #ifdef USE_PARTICLES
     m_gdb = new AmrParGDB(this);
 #endif
@@ -783,6 +813,8 @@ Amr::deleteDerivePlotVar (const std::string& name)
 
 Amr::~Amr ()
 {
+    finishAsyncOutput();
+
     levelbld->variableCleanUp();
 
 #ifdef USE_PARTICLES
@@ -902,6 +934,8 @@ Amr::writePlotFile ()
     BL_PROFILE_REGION_START("Amr::writePlotFile()");
     BL_PROFILE("Amr::writePlotFile()");
 
+    finishAsyncOutput();
+
     VisMF::SetNOutFiles(plot_nfiles);
 
     if (first_plotfile) 
@@ -958,9 +992,13 @@ Amr::writePlotFile ()
         old_prec = HeaderFile.precision(15);
     }
 
+    VisMF::SetAsyncWrite(async_output);
+
     for (int k(0); k <= finest_level; ++k)
         amr_level[k].writePlotFile(pltfileTemp, HeaderFile);
 
+    VisMF::SetAsyncWrite(false);
+
     if (ParallelDescriptor::IOProcessor())
     {
         HeaderFile.precision(old_prec);
@@ -980,17 +1018,29 @@ Amr::writePlotFile ()
         if (ParallelDescriptor::IOProcessor())
             std::cout << "Write plotfile time = " << dPlotFileTime << "  seconds" << "\n\n";
     }
-    ParallelDescriptor::Barrier("Amr::writePlotFile::end");
+    if ( ! async_output)
+    {
+        ParallelDescriptor::Barrier("Amr::writePlotFile::end");
 
-    if(ParallelDescriptor::IOProcessor()) {
-      std::rename(pltfileTemp.c_str(), pltfile.c_str());
+        if(ParallelDescriptor::IOProcessor()) {
+          std::rename(pltfileTemp.c_str(), pltfile.c_str());
+        }
+        ParallelDescriptor::Barrier("Renaming temporary plotfile.");
     }
-    ParallelDescriptor::Barrier("Renaming temporary plotfile.");
     //
     // the plotfile file now has the regular name
     //
 
   }  // end while
+
+  if (async_output)
+  {
+      //
+      // The data files are still being written; finishAsyncOutput() renames.
+      //
+      async_renames.push_back(std::make_pair(pltfileTemp,pltfile));
+  }
+
   BL_PROFILE_REGION_STOP("Amr::writePlotFile()");
 }
 
@@ -1002,6 +1052,8 @@ Amr::writeSmallPlotFile ()
     BL_PROFILE_REGION_START("Amr::writeSmallPlotFile()");
     BL_PROFILE("Amr::writeSmallPlotFile()");
 
+    finishAsyncOutput();
+
     VisMF::SetNOutFiles(plot_nfiles);
 
     if (first_smallplotfile) 
@@ -1062,9 +1114,13 @@ Amr::writeSmallPlotFile ()
         old_prec = HeaderFile.precision(15);
     }
 
+    VisMF::SetAsyncWrite(async_output);
+
     for (int k(0); k <= finest_level; ++k)
         amr_level[k].writeSmallPlotFile(pltfileTemp, HeaderFile);
 
+    VisMF::SetAsyncWrite(false);
+
     if (ParallelDescriptor::IOProcessor())
     {
         HeaderFile.precision(old_prec);
@@ -1084,17 +1140,29 @@ Amr::writeSmallPlotFile ()
         if (ParallelDescriptor::IOProcessor())
             std::cout << "Write small plotfile time = " << dPlotFileTime << "  seconds" << "\n\n";
     }
-    ParallelDescriptor::Barrier("Amr::writeSmallPlotFile::end");
+    if ( ! async_output)
+    {
+        ParallelDescriptor::Barrier("Amr::writeSmallPlotFile::end");
 
-    if(ParallelDescriptor::IOProcessor()) {
-      std::rename(pltfileTemp.c_str(), pltfile.c_str());
+        if(ParallelDescriptor::IOProcessor()) {
+          std::rename(pltfileTemp.c_str(), pltfile.c_str());
+        }
+        ParallelDescriptor::Barrier("Renaming temporary plotfile.");
     }
-    ParallelDescriptor::Barrier("Renaming temporary plotfile.");
     //
     // the plotfile file now has the regular name
     //
 
   }  // end while
+
+  if (async_output)
+  {
+      //
+      // The data files are still being written; finishAsyncOutput() renames.
+      //
+      async_renames.push_back(std::make_pair(pltfileTemp,pltfile));
+  }
+
   BL_PROFILE_REGION_STOP("Amr::writeSmallPlotFile()");
 }
 
@@ -1702,6 +1770,43 @@ Amr::restart (const std::string& filename)
     BL_PROFILE_REGION_STOP("Amr::restart()");
 }
 
+void
+Amr::finishAsyncOutput ()
+{
+    if (async_renames.empty()) return;
+
+    BL_PROFILE("Amr::finishAsyncOutput()");
+
+    int nWriteErrors = VisMF::AsyncWait() ? 0 : 1;
+
+    ParallelDescriptor::ReduceIntSum(nWriteErrors);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        for (std::vector< std::pair<std::string,std::string> >::size_type i = 0;
+             i < async_renames.size(); ++i)
+        {
+            const std::string& tmpName = async_renames[i].first;
+            //
+            // Keep a failed write from taking the final name, as StreamRetry does.
+            //
+            const std::string newName = (nWriteErrors == 0) ? async_renames[i].second
+                                                            : async_renames[i].second + ".bad";
+            if (nWriteErrors > 0)
+                std::cout << nWriteErrors << " ASYNC WRITE ERRORS : Renaming file from "
+                          << tmpName << "  to  " << newName << std::endl;
+
+            std::rename(tmpName.c_str(), newName.c_str());
+        }
+    }
+    async_renames.clear();
+
+    ParallelDescriptor::Barrier("Renaming temporary output files.");
+
+    if (nWriteErrors > 0 && abort_on_stream_retry_failure)
+        BoxLib::Abort("Amr::finishAsyncOutput(): asynchronous write failed");
+}
+
 void
 Amr::checkPoint ()
 {
@@ -1710,6 +1815,8 @@ Amr::checkPoint ()
     BL_PROFILE_REGION_START("Amr::checkPoint()");
     BL_PROFILE("Amr::checkPoint()");
 
+    finishAsyncOutput();
+
     VisMF::SetNOutFiles(checkpoint_nfiles);
     //
     // In checkpoint files always write out FABs in NATIVE format.
@@ -1792,9 +1899,13 @@ Amr::checkPoint ()
         HeaderFile << '\n';
     }
 
+    VisMF::SetAsyncWrite(async_output);
+
     for (i = 0; i <= finest_level; ++i)
         amr_level[i].checkPoint(ckfileTemp, HeaderFile);
 
+    VisMF::SetAsyncWrite(false);
+
     if (ParallelDescriptor::IOProcessor())
     {
         HeaderFile.precision(old_prec);
@@ -1822,15 +1933,26 @@ Amr::checkPoint ()
         if (ParallelDescriptor::IOProcessor())
             std::cout << "checkPoint() time = " << dCheckPointTime << " secs." << '\n';
     }
-    ParallelDescriptor::Barrier("Amr::checkPoint::end");
+    if ( ! async_output)
+    {
+        ParallelDescriptor::Barrier("Amr::checkPoint::end");
 
-    if(ParallelDescriptor::IOProcessor()) {
-      std::rename(ckfileTemp.c_str(), ckfile.c_str());
+        if(ParallelDescriptor::IOProcessor()) {
+          std::rename(ckfileTemp.c_str(), ckfile.c_str());
+        }
+        ParallelDescriptor::Barrier("Renaming temporary checkPoint file.");
     }
-    ParallelDescriptor::Barrier("Renaming temporary checkPoint file.");
 
   }  // end while
 
+  if (async_output)
+  {
+      //
+      // The data files are still being written; finishAsyncOutput() renames.
+      //
+      async_renames.push_back(std::make_pair(ckfileTemp,ckfile));
+  }
+
   //
   // Don't forget to reset FAB format.
   //
@@ -2050,6 +2172,10 @@ Amr::coarseTimeStep (Real stop_time)
 
     amr_level[0].postCoarseTimeStep(cumtime);
 
+    if (use_measured_cost && rebalance_threshold > 0 &&
+        rebalance_int > 0 && level_steps[0] % rebalance_int == 0)
+        rebalance_by_cost();
+
 #ifdef BL_PROFILING
 #ifdef DEBUG
     std::stringstream dfss;
@@ -2424,6 +2550,9 @@ Amr::regrid (int  lbase,
     mgt_flush_copyassoc_cache();
 #endif
 
+    if (use_measured_cost)
+        make_cost_weighted_maps(start,new_finest,new_grid_places);
+
     //
     // Define the new grids from level start up to new_finest.
     //
@@ -2493,6 +2622,8 @@ Amr::regrid (int  lbase,
         for(int iMap(0); iMap < mLDM.size(); ++iMap) {
           MultiFab::MoveAllFabs(mLDM[iMap]);
         }
+        for (int lev = 0; lev <= finest_level; lev++)
+            amr_level[lev].resetCosts();
       Geometry::FlushPIRMCache();
     }
 
@@ -2545,6 +2676,188 @@ Amr::regrid (int  lbase,
     }
 }
 
+//
+// Weights for the boxes in ba given the measured costs of the boxes in
+// old_ba.  Each cell is assigned the cost per cell of the old box that
+// covers it, or the average over old_ba if no old box does.  The weights
+// are normalized so that they sum to the number of cells in ba.
+//
+static
+void
+CostWeights (const BoxArray&    ba,
+             const BoxArray&    old_ba,
+             const Array<Real>& old_cost,
+             std::vector<long>& wgts)
+{
+    BL_ASSERT(old_ba.size() == old_cost.size());
+
+    Real old_total = 0;
+    for (int i = 0, N = old_cost.size(); i < N; i++)
+        old_total += old_cost[i];
+
+    const Real avg_density = old_total / old_ba.numPts();
+
+    std::vector<Real> cost(ba.size(),0);
+    Real total = 0;
+    long ncells = 0;
+
+    for (int i = 0, N = ba.size(); i < N; i++)
+    {
+        const Box& bx = ba[i];
+        long covered = 0;
+
+        std::vector< std::pair<int,Box> > isects;
+        old_ba.intersections(bx,isects);
+
+        for (int j = 0, M = isects.size(); j < M; j++)
+        {
+            const int  k  = isects[j].first;
+            const long np = isects[j].second.numPts();
+            cost[i] += old_cost[k] * np / old_ba[k].numPts();
+            covered += np;
+        }
+        cost[i] += avg_density * (bx.numPts() - covered);
+        total   += cost[i];
+        ncells  += bx.numPts();
+    }
+
+    wgts.resize(ba.size());
+
+    for (int i = 0, N = ba.size(); i < N; i++)
+    {
+        wgts[i] = (total > 0) ? static_cast<long>(cost[i] * ncells / total) : ba[i].numPts();
+        wgts[i] = std::max(wgts[i],1L);
+    }
+}
+
+void
+Amr::make_cost_weighted_maps (int                    start,
+                              int                    new_finest,
+                              const Array<BoxArray>& new_grids)
+{
+    BL_PROFILE("Amr::make_cost_weighted_maps()");
+
+    for (int lev = start; lev <= std::min(new_finest,finest_level); lev++)
+    {
+        if (!amr_level.defined(lev) || new_grids[lev].size() == 0)
+            continue;
+
+        //
+        // All BoxArrays of the same size share a map, so the weighted map
+        // can't replace the map of a level that is kept, of a new level
+        // handled before this one, or of an old finer level that is still
+        // in use while this level is built.
+        //
+        const int nbox   = new_grids[lev].size();
+        bool      shared = false;
+        for (int l = 0; l <= finest_level; l++)
+        {
+            if (l < start || l > lev)
+                shared = shared || (amr_level[l].boxArray().size() == nbox);
+            else if (l < lev)
+                shared = shared || (new_grids[l].size() == nbox);
+        }
+
+        if (shared) continue;
+
+        const Array<Real>& cost = amr_level[lev].getCosts();
+
+        Real total = 0;
+        for (int i = 0; i < cost.size(); i++)
+            total += cost[i];
+
+        if (total <= 0) continue;
+
+        std::vector<long> wgts;
+        CostWeights(new_grids[lev], amr_level[lev].boxArray(), cost, wgts);
+        //
+        // This replaces any cached map of the same size, e.g. the one of
+        // the grids being replaced.
+        //
+        DistributionMapping dm;
+        dm.define(new_grids[lev], wgts, ParallelDescriptor::NProcs());
+    }
+}
+
+void
+Amr::rebalance_by_cost ()
+{
+    BL_PROFILE("Amr::rebalance_by_cost()");
+
+    const int nprocs = ParallelDescriptor::NProcs();
+
+    if (nprocs == 1) return;
+
+    bool moved = false;
+
+    for (int lev = 0; lev <= finest_level; lev++)
+    {
+        const BoxArray&            ba   = amr_level[lev].boxArray();
+        const DistributionMapping& dmap = amr_level[lev].get_new_data(0).DistributionMap();
+        //
+        // Maps are shared by all BoxArrays of the same size,
+        // so only levels with a unique number of grids can be moved.
+        //
+        bool unique = true;
+        for (int l = 0; l <= finest_level; l++)
+            if (l != lev && amr_level[l].boxArray().size() == ba.size())
+                unique = false;
+
+        if (!unique) continue;
+
+        const Array<Real>& cost = amr_level[lev].getCosts();
+
+        Array<Real> load(nprocs,0);
+        Real total = 0;
+        for (int i = 0; i < cost.size(); i++)
+        {
+            load[dmap[i]] += cost[i];
+            total         += cost[i];
+        }
+
+        if (total <= 0) continue;
+
+        const Real avg      = total / nprocs;
+        const Real max_load = *std::max_element(load.begin(), load.end());
+
+        if (max_load <= rebalance_threshold * avg) continue;
+
+        std::vector<long> wgts;
+        CostWeights(ba, ba, cost, wgts);
+
+        DistributionMapping newmap;
+        newmap.WeightedProcessorMap(ba, wgts, nprocs);
+
+        Array<Real> new_load(nprocs,0);
+        for (int i = 0; i < cost.size(); i++)
+            new_load[newmap[i]] += cost[i];
+
+        const Real new_max_load = *std::max_element(new_load.begin(), new_load.end());
+
+        if (verbose > 0 && ParallelDescriptor::IOProcessor())
+            std::cout << "Amr::rebalance_by_cost: level " << lev
+                      << " max/avg load " << max_load/avg
+                      << " -> " << new_max_load/avg << std::endl;
+
+        if (new_max_load < max_load)
+        {
+            Array<int> pmap(newmap.ProcessorMap());
+            MultiFab::MoveAllFabs(pmap);
+            moved = true;
+        }
+
+        amr_level[lev].resetCosts();
+    }
+
+    if (moved)
+    {
+        Geometry::FlushPIRMCache();
+#ifdef USE_PARTICLES
+        amr_level[0].particle_redistribute(0);
+#endif
+    }
+}
+
 void
 Amr::regrid_level_0_on_restart()
 {
@@ -2789,6 +3102,78 @@ Amr::ProjPeriodic (BoxList&        blout,
     }
 }
 
+//
+// Replace the cell-centered bl on every CPU by the concatenation, in CPU
+// order, of the BoxLists on all CPUs.
+//
+static
+void
+AllGatherBoxes (BoxList& bl)
+{
+    BL_ASSERT(bl.ixType().cellCentered());
+#if BL_USE_MPI
+    const int NProcs = ParallelDescriptor::NProcs();
+    const int NInts  = 2*BL_SPACEDIM;
+
+    Array<int> sendbuf;
+    sendbuf.reserve(bl.size()*NInts);
+
+    for (BoxList::const_iterator it = bl.begin(), End = bl.end(); it != End; ++it)
+    {
+        for (int n = 0; n < BL_SPACEDIM; n++)
+            sendbuf.push_back(it->smallEnd(n));
+        for (int n = 0; n < BL_SPACEDIM; n++)
+            sendbuf.push_back(it->bigEnd(n));
+    }
+
+    int count = sendbuf.size();
+
+    Array<int> counts(NProcs,0), offset(NProcs,0);
+
+    BL_COMM_PROFILE(BLProfiler::Allgather, sizeof(int), BLProfiler::BeforeCall(),
+                    BLProfiler::NoTag());
+    MPI_Allgather(&count,
+                  1,
+                  ParallelDescriptor::Mpi_typemap<int>::type(),
+                  counts.dataPtr(),
+                  1,
+                  ParallelDescriptor::Mpi_typemap<int>::type(),
+                  ParallelDescriptor::Communicator());
+    BL_COMM_PROFILE(BLProfiler::Allgather, sizeof(int), BLProfiler::AfterCall(),
+                    BLProfiler::NoTag());
+
+    for (int i = 1; i < NProcs; i++)
+        offset[i] = offset[i-1] + counts[i-1];
+
+    const int total = offset[NProcs-1] + counts[NProcs-1];
+
+    if (total == 0) return;
+
+    Array<int> recvbuf(total);
+
+    BL_COMM_PROFILE(BLProfiler::Allgather, total * sizeof(int), BLProfiler::BeforeCall(),
+                    BLProfiler::NoTag());
+    MPI_Allgatherv(count > 0 ? sendbuf.dataPtr() : 0,
+                   count,
+                   ParallelDescriptor::Mpi_typemap<int>::type(),
+                   recvbuf.dataPtr(),
+                   counts.dataPtr(),
+                   offset.dataPtr(),
+                   ParallelDescriptor::Mpi_typemap<int>::type(),
+                   ParallelDescriptor::Communicator());
+    BL_COMM_PROFILE(BLProfiler::Allgather, total * sizeof(int), BLProfiler::AfterCall(),
+                    BLProfiler::NoTag());
+
+    bl.clear();
+
+    for (int i = 0; i < total; i += NInts)
+    {
+        const int* p = recvbuf.dataPtr() + i;
+        bl.push_back(Box(IntVect(p),IntVect(p+BL_SPACEDIM)));
+    }
+#endif
+}
+
 void
 Amr::grid_places (int              lbase,
                   Real             time,
@@ -3096,33 +3481,57 @@ Amr::grid_places (int              lbase,
         //
         // Create initial cluster containing all tagged points.
         //
+        // With distributed_clustering each CPU only clusters the tags in the
+        // region it owns, and the resulting boxes are then gathered to all.
+        // This avoids gathering every tag to the IOProcessor, at the price
+        // of boxes that also get cut along the ownership boundaries.
+        //
         long     len = 0;
-        IntVect* pts = tags.collate(len);
+        BoxList  region;
+        IntVect* pts = distributed_clustering ? tags.collateLocal(len,region)
+                                              : tags.collate(len);
 
         tags.clear();
 
-        if (len > 0)
+        long ntags = len;
+
+        if (distributed_clustering)
+            ParallelDescriptor::ReduceLongSum(ntags);
+
+        if (ntags > 0)
         {
             //
             // Created new level, now generate efficient grids.
             //
             if ( !(useFixedCoarseGrids && levc<useFixedUpToLevel) )
                 new_finest = std::max(new_finest,levf);
-            //
-            // Construct initial cluster.
-            //
-            ClusterList clist(pts,len);
-            clist.chop(grid_eff);
-            BoxDomain bd;
-            bd.add(p_n[levc]);
-            clist.intersect(bd);
-            bd.clear();
-            //
-            // Efficient properly nested Clusters have been constructed
-            // now generate list of grids at level levf.
-            //
+
             BoxList new_bx;
-            clist.boxList(new_bx);
+
+            if (len > 0)
+            {
+                //
+                // Construct initial cluster.
+                //
+                ClusterList clist(pts,len);
+                clist.chop(grid_eff);
+                BoxDomain bd;
+                if (distributed_clustering)
+                    bd.add(BoxLib::intersect(p_n[levc],region));
+                else
+                    bd.add(p_n[levc]);
+                clist.intersect(bd);
+                bd.clear();
+                //
+                // Efficient properly nested Clusters have been constructed
+                // now generate list of grids at level levf.
+                //
+                clist.boxList(new_bx);
+            }
+
+            if (distributed_clustering)
+                AllGatherBoxes(new_bx);
+
             new_bx.refine(bf_lev[levc]);
             new_bx.simplify();
             BL_ASSERT(new_bx.isDisjoint());
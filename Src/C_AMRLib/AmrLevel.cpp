@@ -53,6 +53,7 @@ AmrLevel::AmrLevel ()
 {
    parent = 0;
    level = -1;
+   costs_total = 0;
 }
 
 AmrLevel::AmrLevel (Amr&            papa,
@@ -229,7 +230,10 @@ AmrLevel::set_state_in_checkpoint (Array<int>& state_in_checkpoint)
 }
 
 void
-AmrLevel::finishConstructor () {}
+AmrLevel::finishConstructor ()
+{
+    resetCosts();
+}
 
 #ifdef USE_PARTICLES
 void
@@ -1857,9 +1861,87 @@ AmrLevel::which_time (int  indx,
 Real
 AmrLevel::estimateWork ()
 {
+    //
+    // The total from the last getCosts(), so no communication is needed here.
+    //
+    if (parent->useMeasuredCost() && costs_total > 0)
+        return costs_total;
+
     return 1.0*countCells();
 }
 
+void
+AmrLevel::addCost (const MFIter& mfi,
+                   Real          cost)
+{
+    BL_ASSERT(box_costs.size() == grids.size());
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+    box_costs[mfi.index()] += cost;
+}
+
+bool
+AmrLevel::costLayoutChanged () const
+{
+    if (!BoxArray::SameRefs(costs_grids,grids))
+        return true;
+
+    return desc_lst.size() > 0 &&
+        !DistributionMapping::SameRefs(costs_dmap,state[0].newData().DistributionMap());
+}
+
+void
+AmrLevel::resetCosts ()
+{
+    costs_grids = grids;
+
+    if (desc_lst.size() > 0)
+        costs_dmap = state[0].newData().DistributionMap();
+
+    box_costs.resize(grids.size());
+
+    for (int i = 0, N = box_costs.size(); i < N; i++)
+        box_costs[i] = 0;
+
+    costs_total = 0;
+}
+
+Array<Real>
+AmrLevel::getCosts ()
+{
+    //
+    // Costs measured on another BoxArray or DistributionMapping are useless.
+    //
+    if (costLayoutChanged())
+        resetCosts();
+
+    Array<Real> costs(box_costs);
+
+    if (costs.size() > 0)
+        ParallelDescriptor::ReduceRealSum(costs.dataPtr(),costs.size());
+
+    costs_total = 0;
+    for (int i = 0, N = costs.size(); i < N; i++)
+        costs_total += costs[i];
+
+    return costs;
+}
+
+AmrLevel::CostTimer::CostTimer (AmrLevel&     amrlevel,
+                                const MFIter& mfi)
+    :
+    m_level(amrlevel),
+    m_mfi(mfi),
+    m_start(amrlevel.parent->useMeasuredCost() ? ParallelDescriptor::second() : -1)
+{}
+
+AmrLevel::CostTimer::~CostTimer ()
+{
+    if (m_start >= 0)
+        m_level.addCost(m_mfi, ParallelDescriptor::second() - m_start);
+}
+
 bool
 AmrLevel::writePlotNow ()
 {
@@ -1939,3 +2021,142 @@ AmrLevel::FillPatch(AmrLevel& amrlevel,
     const MultiFab& mf_fillpatched = fpi.get_mf();
     MultiFab::Copy(leveldata, mf_fillpatched, 0, dcomp, ncomp, boxGrow);
 }
+
+void
+AmrLevel::FillPatchFromOld (AmrLevel& old,
+                            MultiFab& leveldata,
+                            Real      time,
+                            int       index,
+                            int       scomp,
+                            int       ncomp,
+                            int       dcomp)
+{
+    BL_PROFILE("AmrLevel::FillPatchFromOld()");
+
+    BL_ASSERT(dcomp+ncomp-1 <= leveldata.nComp());
+
+    PArray<MultiFab>  smf;
+    std::vector<Real> stime;
+    old.state[index].getData(smf,stime,time);
+
+    if (smf.size() != 1)
+    {
+        //
+        // We'd have to interpolate in time; let FillPatch do it all.
+        //
+        FillPatch(old,leveldata,0,time,index,scomp,ncomp,dcomp);
+        return;
+    }
+
+    MultiFab&       old_mf = smf[0];
+    const BoxArray& old_ba = old_mf.boxArray();
+    const BoxArray& new_ba = leveldata.boxArray();
+    //
+    // Only the parts of the new grids outside the old level need
+    // FillPatch.  The list is built from the BoxArrays, so it's the same
+    // on every process.
+    //
+    BoxList new_bl(new_ba.ixType());
+
+    for (int i = 0, N = new_ba.size(); i < N; i++)
+    {
+        BoxList bl = old_ba.complement(new_ba[i]);
+        new_bl.catenate(bl);
+    }
+
+    MultiFab mf_new;
+
+    if (!new_bl.isEmpty())
+    {
+        mf_new.define(BoxArray(new_bl),ncomp,0,Fab_allocate);
+
+        FillPatch(old,mf_new,0,time,index,scomp,ncomp);
+    }
+    //
+    // A new grid that is an old grid on the same process takes over the
+    // old FAB when the whole FAB is wanted.  The old grids are disjoint,
+    // so no other new grid needs anything from it.
+    //
+    const bool can_move = scomp == 0 && dcomp == 0
+        && ncomp == leveldata.nComp() && ncomp == old_mf.nComp()
+        && leveldata.nGrow() == old_mf.nGrow()
+        && ParallelDescriptor::TeamSize() == 1;
+
+    std::vector< std::pair<int,int> > moves;
+    std::vector<bool>                 moved(old_ba.size(),false);
+
+    if (can_move)
+    {
+        std::vector< std::pair<int,Box> > isects;
+
+        for (int i = 0, N = new_ba.size(); i < N; i++)
+        {
+            old_ba.intersections(new_ba[i],isects);
+
+            for (int k = 0, M = isects.size(); k < M; k++)
+            {
+                const int j = isects[k].first;
+
+                if (old_ba[j] == new_ba[i] &&
+                    old_mf.DistributionMap()[j] == leveldata.DistributionMap()[i])
+                {
+                    moved[j] = true;
+                    if (leveldata.DistributionMap()[i] == ParallelDescriptor::MyProc())
+                        moves.push_back(std::make_pair(i,j));
+                }
+            }
+        }
+    }
+
+    BoxList     rest_bl(old_ba.ixType());
+    Array<int>  rest_map;
+    Array<int>  rest_idx;
+
+    for (int j = 0, N = old_ba.size(); j < N; j++)
+    {
+        if (!moved[j])
+        {
+            rest_bl.push_back(old_ba[j]);
+            rest_map.push_back(old_mf.DistributionMap()[j]);
+            rest_idx.push_back(j);
+        }
+    }
+
+    if (rest_idx.size() == old_ba.size())
+    {
+        //
+        // Nothing to move; everything inside the old level is a straight copy.
+        //
+        leveldata.copy(old_mf,scomp,dcomp,ncomp);
+    }
+    else
+    {
+        if (!rest_bl.isEmpty())
+        {
+            //
+            // Copy from the old FABs that aren't moved, lent to a FabArray
+            // over just their boxes.
+            //
+            rest_map.push_back(ParallelDescriptor::MyProc());
+
+            MultiFab rest(BoxArray(rest_bl),old_mf.nComp(),old_mf.nGrow(),
+                          DistributionMapping(rest_map),Fab_noallocate);
+
+            for (int k = 0, N = rest_idx.size(); k < N; k++)
+                if (rest_map[k] == ParallelDescriptor::MyProc())
+                    rest.swapFab(k,old_mf,rest_idx[k]);
+
+            leveldata.copy(rest,scomp,dcomp,ncomp);
+
+            for (int k = 0, N = rest_idx.size(); k < N; k++)
+                if (rest_map[k] == ParallelDescriptor::MyProc())
+                    rest.swapFab(k,old_mf,rest_idx[k]);
+        }
+
+        for (int k = 0, N = moves.size(); k < N; k++)
+            leveldata.swapFab(moves[k].first,old_mf,moves[k].second);
+    }
+
+    if (!new_bl.isEmpty())
+        leveldata.copy(mf_new,0,dcomp,ncomp);
+}
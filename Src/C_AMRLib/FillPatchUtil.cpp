@@ -87,11 +87,7 @@ namespace BoxLib
 	    
 	    if (sameba)
 	    {
-		mf.FillBoundary_nowait(dcomp,ncomp);
-		geom.FillPeriodicBoundary_nowait(mf,dcomp,ncomp);
-
-		mf.FillBoundary_finish();
-		geom.FillPeriodicBoundary_finish(mf);
+		mf.FillBoundary(dcomp,ncomp,geom);
 	    }
 	    else
 	    {
@@ -142,7 +138,9 @@ namespace BoxLib
 
 	    if (!fpc.ba_crse_patch.empty())
 	    {
-		MultiFab mf_crse_patch(fpc.ba_crse_patch, ncomp, 0, fpc.dm_crse_patch);
+		// The coarse patch and its copy patterns are cached with the FPC,
+		// so after the first fill this is just data movement and interpolation.
+		MultiFab& mf_crse_patch = fpc.crsePatch(ncomp);
 		
 		FillPatchSingleLevel(mf_crse_patch, time, cmf, ct, scomp, 0, ncomp, cgeom, cbc);
 		
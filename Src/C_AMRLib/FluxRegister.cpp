@@ -8,8 +8,18 @@
 #include <BLProfiler.H>
 #include <ccse-mpi.H>
 
+#include <algorithm>
 #include <vector>
 
+namespace
+{
+    bool
+    CompareIndex (const std::pair<int,Box>& a, const std::pair<int,Box>& b)
+    {
+        return a.first < b.first;
+    }
+}
+
 FluxRegister::FluxRegister ()
 {
     fine_level = ncomp = -1;
@@ -80,6 +90,8 @@ FluxRegister::define (const BoxArray& fine_boxes,
     grids.define(fine_boxes);
     grids.coarsen(ratio);
 
+    clearRefluxTags();
+
     for (int dir = 0; dir < BL_SPACEDIM; dir++)
     {
         const Orientation lo_face(dir,Orientation::low);
@@ -111,6 +123,8 @@ FluxRegister::define (const BoxArray&            fine_boxes,
     grids.define(fine_boxes);
     grids.coarsen(ratio);
 
+    clearRefluxTags();
+
     for (int dir = 0; dir < BL_SPACEDIM; dir++)
     {
         const Orientation lo_face(dir,Orientation::low);
@@ -127,6 +141,21 @@ FluxRegister::define (const BoxArray&            fine_boxes,
 
 FluxRegister::~FluxRegister () {}
 
+void
+FluxRegister::clear ()
+{
+    grids.clear();
+
+    for (int i = 0; i < 2*BL_SPACEDIM; i++)
+        bndry[i].clear();
+
+    fine_level = ncomp = -1;
+    ratio = IntVect::TheUnitVector();
+    ratio.scale(-1);
+
+    clearRefluxTags();
+}
+
 Real
 FluxRegister::SumReg (int comp) const
 {
@@ -161,73 +190,108 @@ FluxRegister::CrseInit (const MultiFab& mflx,
                         Real            mult,
                         FrOp            op)
 {
+    CrseInit_doit(mflx,&area,dir,srccomp,destcomp,numcomp,mult,op);
+}
+
+void
+FluxRegister::CrseInit (const MultiFab& mflx,
+                        int             dir,
+                        int             srccomp,
+                        int             destcomp,
+                        int             numcomp,
+                        Real            mult,
+                        FrOp            op)
+{
+    CrseInit_doit(mflx,0,dir,srccomp,destcomp,numcomp,mult,op);
+}
+
+void
+FluxRegister::CrseInit_doit (const MultiFab& mflx,
+                             const MultiFab* area,
+                             int             dir,
+                             int             srccomp,
+                             int             destcomp,
+                             int             numcomp,
+                             Real            mult,
+                             FrOp            op)
+{
+    BL_PROFILE("FluxRegister::CrseInit()");
+
     BL_ASSERT(srccomp >= 0 && srccomp+numcomp <= mflx.nComp());
     BL_ASSERT(destcomp >= 0 && destcomp+numcomp <= ncomp);
 
     const Orientation face_lo(dir,Orientation::low);
     const Orientation face_hi(dir,Orientation::high);
- 
-    MultiFab mf(mflx.boxArray(),numcomp,0);
 
-#ifdef _OPENMP
-#pragma omp parallel
-#endif    
-    for (MFIter mfi(mflx,true); mfi.isValid(); ++mfi)
-    {
-	const Box& bx = mfi.tilebox();
-	
-        mf[mfi].copy(mflx[mfi],bx,srccomp,bx,0,numcomp);
-
-        mf[mfi].mult(mult,bx,0,numcomp);
-
-        for (int i = 0; i < numcomp; i++)
-            mf[mfi].mult(area[mfi],bx,bx,0,i,1);
-    }
+    std::vector< std::pair<int,Box> > isects;
 
     for (int pass = 0; pass < 2; pass++)
     {
         const Orientation face = ((pass == 0) ? face_lo : face_hi);
 
+        FabSet& reg = bndry[face];
+        //
+        // Pull just the register faces out of mflx (and area) and scale
+        // them there, rather than scaling a copy of all of mflx.
+        //
+        FabSet fs;
+
+        fs.define(reg.boxArray(),numcomp,reg.DistributionMap());
+
+        fs.setVal(0);
+
+        fs.copyFrom(mflx,0,srccomp,0,numcomp);
+
+        fs.mult(mult,0,numcomp);
+
+        if (area != 0)
+        {
+            FabSet fa;
+
+            fa.define(reg.boxArray(),1,reg.DistributionMap());
+
+            fa.setVal(0);
+
+            fa.copyFrom(*area,0,0,0,1);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+            for (FabSetIter fsi(fs); fsi.isValid(); ++fsi)
+            {
+                for (int i = 0; i < numcomp; i++)
+                    fs[fsi].mult(fa[fsi],0,i,1);
+            }
+        }
+
         if (op == FluxRegister::COPY)
         {
-            bndry[face].copyFrom(mf,0,0,destcomp,numcomp);
+            //
+            // Only overwrite the faces mflx actually covers.
+            //
+            for (FabSetIter fsi(fs); fsi.isValid(); ++fsi)
+            {
+                mflx.boxArray().intersections(fs[fsi].box(),isects);
+
+                for (int i = 0, N = isects.size(); i < N; i++)
+                {
+                    const Box& bx = isects[i].second;
+
+                    reg[fsi].copy(fs[fsi],bx,0,bx,destcomp,numcomp);
+                }
+            }
         }
         else
         {
-            FabSet fs(bndry[face].boxArray(),numcomp);
-
-            fs.setVal(0);
-
-            fs.copyFrom(mf,0,0,0,numcomp);
-
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
-            for (FabSetIter mfi(fs); mfi.isValid(); ++mfi)
-                bndry[face][mfi].plus(fs[mfi],0,destcomp,numcomp);
+            for (FabSetIter fsi(fs); fsi.isValid(); ++fsi)
+                reg[fsi].plus(fs[fsi],0,destcomp,numcomp);
         }
     }
 }
 
-void
-FluxRegister::CrseInit (const MultiFab& mflx,
-                        int             dir,
-                        int             srccomp,
-                        int             destcomp,
-                        int             numcomp,
-                        Real            mult,
-                        FrOp            op)
-{
-    BL_ASSERT(srccomp >= 0 && srccomp+numcomp <= mflx.nComp());
-    BL_ASSERT(destcomp >= 0 && destcomp+numcomp <= ncomp);
-
-    MultiFab area(mflx.boxArray(), 1, mflx.nGrow());
-
-    area.setVal(1, 0, 1, area.nGrow());
-
-    CrseInit(mflx,area,dir,srccomp,destcomp,numcomp,mult,op);
-}
-
 void
 FluxRegister::FineAdd (const MultiFab& mflx,
                        int             dir,
@@ -366,63 +430,367 @@ FluxRegister::Reflux (MultiFab&       mf,
 		      int             ncomp,
 		      const Geometry& geom)
 {
-    BL_PROFILE("FluxRegister::Reflux()");
+    Reflux_doit(mf,&volume,0,scale,scomp,dcomp,ncomp,geom);
+}
+
+void 
+FluxRegister::Reflux (MultiFab&       mf,
+		      Real            scale,
+		      int             scomp,
+		      int             dcomp,
+		      int             ncomp,
+		      const Geometry& geom)
+{
+    const Real* dx = geom.CellSize();
+
+    Reflux_doit(mf,0,D_TERM(dx[0],*dx[1],*dx[2]),scale,scomp,dcomp,ncomp,geom);
+}
+
+void
+FluxRegister::buildRefluxTags (const MultiFab& mf,
+                               const Geometry& geom)
+{
+    //
+    // The processor maps are compared by value: MoveAllFabs() changes
+    // them in place, for mf and for the register alike.
+    //
+    if (m_rf_ba     == mf.boxArray()                              &&
+        m_rf_domain == geom.Domain()                              &&
+        m_rf_pmap   == mf.DistributionMap().ProcessorMap()        &&
+        m_rf_rpmap  == bndry[0].DistributionMap().ProcessorMap())
+        return;
+
+    BL_PROFILE("FluxRegister::buildRefluxTags()");
+
+    BL_ASSERT(mf.boxArray().ixType().cellCentered());
+
+    m_rf_ba     = mf.boxArray();
+    m_rf_domain = geom.Domain();
+    m_rf_pmap   = mf.DistributionMap().ProcessorMap();
+    m_rf_rpmap  = bndry[0].DistributionMap().ProcessorMap();
+
+    m_rf_loc.clear();
+    m_rf_snd.clear();
+    m_rf_rcv.clear();
+    m_rf_sndvol.clear();
+    m_rf_rcvvol.clear();
+
+    const int                  MyProc = ParallelDescriptor::MyProc();
+    const BoxArray&            ba     = mf.boxArray();
+    const DistributionMapping& dm     = mf.DistributionMap();
+
+    std::vector< std::pair<int,Box> > isects;
+    Array<IntVect>                    pshifts;
+    std::vector<IntVect>              shifts;
 
     for (OrientationIter fi; fi; ++fi)
     {
-	const Orientation& face = fi();
-	int idir = face.coordDir();
-	int islo = face.isLow();
+        const Orientation          face = fi();
+        const int                  idir = face.coordDir();
+        const BoxArray&            rba  = bndry[face].boxArray();
+        const DistributionMapping& rdm  = bndry[face].DistributionMap();
+
+        for (int k = 0, N = rba.size(); k < N; k++)
+        {
+            const Box& rbx = rba[k];
+            //
+            // The coarse cells on the far side of these faces from the fine grid.
+            //
+            Box cbx(rbx.smallEnd(), rbx.bigEnd());
+
+            if (face.isLow())
+                cbx.shift(idir,-1);
+
+            shifts.assign(1,IntVect::TheZeroVector());
+
+            if (geom.isAnyPeriodic())
+            {
+                geom.periodicShift(geom.Domain(),cbx,pshifts);
+
+                shifts.insert(shifts.end(),pshifts.begin(),pshifts.end());
+            }
+
+            for (int s = 0, NS = shifts.size(); s < NS; s++)
+            {
+                ba.intersections(cbx+shifts[s],isects);
+                //
+                // All processes must list the tags in the same order.
+                //
+                std::sort(isects.begin(),isects.end(),CompareIndex);
+
+                for (int i = 0, NI = isects.size(); i < NI; i++)
+                {
+                    const int j         = isects[i].first;
+                    const int src_owner = rdm[k];
+                    const int dst_owner = dm[j];
+
+                    if (src_owner != MyProc && dst_owner != MyProc)
+                        continue;
+
+                    Box fbx = isects[i].second - shifts[s];
+
+                    if (face.isLow())
+                        fbx.shift(idir,1);
+
+                    RefluxTag tag;
+
+                    tag.fbox   = Box(fbx.smallEnd(), fbx.bigEnd(), rbx.ixType());
+                    tag.cbox   = isects[i].second;
+                    tag.shift  = shifts[s];
+                    tag.face   = face;
+                    tag.dir    = idir;
+                    tag.islo   = face.isLow();
+                    tag.sindex = k;
+                    tag.dindex = j;
+
+                    const int npts = tag.fbox.numPts();
+
+                    if (src_owner == MyProc && dst_owner == MyProc)
+                    {
+                        m_rf_loc.push_back(tag);
+                    }
+                    else if (src_owner == MyProc)
+                    {
+                        m_rf_snd[dst_owner].push_back(tag);
+                        m_rf_sndvol[dst_owner] += npts;
+                    }
+                    else
+                    {
+                        m_rf_rcv[src_owner].push_back(tag);
+                        m_rf_rcvvol[src_owner] += npts;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void
+FluxRegister::clearRefluxTags ()
+{
+    m_rf_ba.clear();
+    m_rf_domain = Box();
+    m_rf_pmap.clear();
+    m_rf_rpmap.clear();
+    m_rf_loc.clear();
+    m_rf_snd.clear();
+    m_rf_rcv.clear();
+    m_rf_sndvol.clear();
+    m_rf_rcvvol.clear();
+}
+
+bool
+FluxRegister::RefluxItemLess (const RefluxItem& a,
+                              const RefluxItem& b)
+{
+    return a.tag->dindex < b.tag->dindex;
+}
+
+void
+FluxRegister::applyReflux (RefluxItems&    items,
+                           MultiFab&       mf,
+                           const MultiFab* volume,
+                           Real            cvol,
+                           Real            scale,
+                           int             dcomp,
+                           int             ncomp)
+{
+    //
+    // The sort is stable so each coarse cell gets its updates in the
+    // same order as before.
+    //
+    std::stable_sort(items.begin(),items.end(),RefluxItemLess);
+
+    std::vector<int> runs;
+
+    for (int i = 0, N = items.size(); i < N; i++)
+        if (i == 0 || items[i].tag->dindex != items[i-1].tag->dindex)
+            runs.push_back(i);
 
-	MultiFab flux(mf.boxArray(), ncomp, 0, Fab_allocate, IntVect::TheDimensionVector(idir));
-	flux.setVal(0.0);
+    runs.push_back(items.size());
 
-	flux.copy(bndry[face], scomp, 0, ncomp, 0, 0);
-	geom.PeriodicCopy(flux, bndry[face], 0, scomp, ncomp);
+    const int NR = runs.size() - 1;
 
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
-	for (MFIter mfi(mf,true); mfi.isValid(); ++mfi)
-	{
-	    const Box& bx = mfi.tilebox();
-
-	    FArrayBox& sfab = mf[mfi];
-	    const Box& sbox = sfab.box();
-
-	    const FArrayBox& ffab = flux[mfi];
-	    const Box& fbox = ffab.box();
-	    
-	    const FArrayBox& vfab = volume[mfi];
-	    const Box& vbox = vfab.box();
-
-	    FORT_FRREFLUX(bx.loVect(), bx.hiVect(),
-			  sfab.dataPtr(dcomp), sbox.loVect(), sbox.hiVect(),
-			  ffab.dataPtr(     ), fbox.loVect(), fbox.hiVect(),
-			  vfab.dataPtr(     ), vfab.loVect(), vbox.hiVect(),
-			  &ncomp, &scale, &idir, &islo);
-			  
-	}
+    {
+        FArrayBox cvfab;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+        for (int r = 0; r < NR; r++)
+        {
+            for (int i = runs[r]; i < runs[r+1]; i++)
+            {
+                const RefluxItem& it = items[i];
+
+                applyReflux(*it.tag,it.fdat,it.fdatbox,
+                            mf,volume,cvol,scale,dcomp,ncomp,cvfab);
+            }
+        }
     }
 }
 
-void 
-FluxRegister::Reflux (MultiFab&       mf,
-		      Real            scale,
-		      int             scomp,
-		      int             dcomp,
-		      int             ncomp,
-		      const Geometry& geom)
+void
+FluxRegister::applyReflux (const RefluxTag& tag,
+                           const Real*      fdat,
+                           const Box&       fdatbox,
+                           MultiFab&        mf,
+                           const MultiFab*  volume,
+                           Real             cvol,
+                           Real             scale,
+                           int              dcomp,
+                           int              ncomp,
+                           FArrayBox&       cvfab)
 {
-    const Real* dx = geom.CellSize();
-    
-    MultiFab volume(mf.boxArray(), 1, mf.nGrow());
-    
-    volume.setVal(D_TERM(dx[0],*dx[1],*dx[2]), 0, 1, mf.nGrow());
+    FArrayBox& sfab = mf[tag.dindex];
+    const Box& sbox = sfab.box();
 
-    Reflux(mf,volume,scale,scomp,dcomp,ncomp,geom);
+    const FArrayBox* vfab;
+
+    if (volume != 0)
+    {
+        vfab = &(*volume)[tag.dindex];
+    }
+    else
+    {
+        //
+        // resize() only reallocates when cvfab grows.
+        //
+        cvfab.resize(tag.cbox,1);
+        cvfab.setVal(cvol);
+        vfab = &cvfab;
+    }
+
+    const Box& vbox = vfab->box();
+
+    FORT_FRREFLUX(tag.cbox.loVect(), tag.cbox.hiVect(),
+                  sfab.dataPtr(dcomp), sbox.loVect(), sbox.hiVect(),
+                  fdat, fdatbox.loVect(), fdatbox.hiVect(),
+                  vfab->dataPtr(), vbox.loVect(), vbox.hiVect(),
+                  &ncomp, &scale, &tag.dir, &tag.islo);
 }
 
+void 
+FluxRegister::Reflux_doit (MultiFab&       mf,
+                           const MultiFab* volume,
+                           Real            cvol,
+                           Real            scale,
+                           int             scomp,
+                           int             dcomp,
+                           int             ncomp,
+                           const Geometry& geom)
+{
+    BL_PROFILE("FluxRegister::Reflux()");
+
+    BL_ASSERT(scomp >= 0 && scomp+ncomp <= nComp());
+    BL_ASSERT(dcomp >= 0 && dcomp+ncomp <= mf.nComp());
+
+    buildRefluxTags(mf,geom);
+    //
+    // Register data goes straight to the owners of the coarse cells it
+    // updates: one message per neighbor for all faces and periodic images.
+    // Different tags can hit the same cell, so only those on different
+    // coarse fabs are applied in parallel.
+    //
+#ifdef BL_USE_MPI
+    const int SeqNum = ParallelDescriptor::SeqNum();
+    const int N_rcvs = m_rf_rcv.size();
+    const int N_snds = m_rf_snd.size();
+
+    Real*              the_recv_data = 0;
+    Array<Real*>       recv_data;
+    Array<int>         recv_from;
+    Array<MPI_Request> recv_reqs;
+
+    if (N_rcvs > 0)
+        FabArrayBase::PostRcvs(m_rf_rcvvol,the_recv_data,
+                               recv_data,recv_from,recv_reqs,ncomp,SeqNum);
+
+    Array<Real*>       send_data;
+    Array<MPI_Request> send_reqs;
+
+    for (MapOfRefluxTags::const_iterator it = m_rf_snd.begin(), End = m_rf_snd.end();
+         it != End;
+         ++it)
+    {
+        const int N = m_rf_sndvol[it->first]*ncomp;
+
+        Real* dptr = static_cast<Real*>(BoxLib::The_Arena()->alloc(N*sizeof(Real)));
+
+        send_data.push_back(dptr);
+
+        for (RefluxTags::const_iterator tit = it->second.begin(), TEnd = it->second.end();
+             tit != TEnd;
+             ++tit)
+        {
+            bndry[tit->face][tit->sindex].copyToMem(tit->fbox,scomp,ncomp,dptr);
+
+            dptr += tit->fbox.numPts()*ncomp;
+        }
+
+        send_reqs.push_back(ParallelDescriptor::Asend(send_data.back(),N,it->first,SeqNum).req());
+    }
+#endif
+    //
+    // Do the local work while the messages are in flight.
+    //
+    RefluxItems items;
+
+    items.reserve(m_rf_loc.size());
+
+    for (int i = 0, N = m_rf_loc.size(); i < N; i++)
+    {
+        const RefluxTag& tag  = m_rf_loc[i];
+        const FArrayBox& rfab = bndry[tag.face][tag.sindex];
+        const RefluxItem it   = { &tag, rfab.dataPtr(scomp), rfab.box()+tag.shift };
+
+        items.push_back(it);
+    }
+
+    applyReflux(items,mf,volume,cvol,scale,dcomp,ncomp);
+
+#ifdef BL_USE_MPI
+    if (N_rcvs > 0)
+    {
+        Array<MPI_Status> stats(N_rcvs);
+
+        BL_MPI_REQUIRE( MPI_Waitall(N_rcvs, recv_reqs.dataPtr(), stats.dataPtr()) );
+
+        items.clear();
+
+        for (int k = 0; k < N_rcvs; k++)
+        {
+            const Real*       dptr = recv_data[k];
+            const RefluxTags& tags = m_rf_rcv[recv_from[k]];
+
+            for (RefluxTags::const_iterator tit = tags.begin(), TEnd = tags.end();
+                 tit != TEnd;
+                 ++tit)
+            {
+                const RefluxItem it = { &(*tit), dptr, tit->fbox+tit->shift };
+
+                items.push_back(it);
+
+                dptr += tit->fbox.numPts()*ncomp;
+            }
+        }
+
+        applyReflux(items,mf,volume,cvol,scale,dcomp,ncomp);
+
+        BoxLib::The_Arena()->free(the_recv_data);
+    }
+
+    if (N_snds > 0)
+    {
+        Array<MPI_Status> stats;
+
+        FabArrayBase::GrokAsyncSends(N_snds,send_reqs,send_data,stats);
+    }
+#endif
+}
 
 void
 FluxRegister::write (const std::string& name, std::ostream& os) const
@@ -451,4 +819,6 @@ FluxRegister::read (const std::string& name, std::istream& is)
     BndryRegister* br = this;
 
     br->read(name,is);
+
+    clearRefluxTags();
 }
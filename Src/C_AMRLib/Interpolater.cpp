@@ -6,6 +6,7 @@
 #include <Geometry.H>
 #include <Interpolater.H>
 #include <INTERP_F.H>
+#include <MemPool.H>
 
 //
 // Note that in 1D, CellConservativeProtected and CellQuadratic
@@ -24,6 +25,28 @@ CellConservativeLinear    cell_cons_interp(0);
 CellConservativeProtected protected_interp;
 CellConservativeQuartic   quartic_interp;
 
+namespace
+{
+    //
+    // Scratch space for the interpolation kernels.  It comes from the
+    // memory pool so that the many small calls made during a FillPatch
+    // don't go back to the system allocator for each temporary.
+    //
+    class InterpScratch
+    {
+    public:
+        explicit InterpScratch (long n)
+            :
+            m_ptr(static_cast<Real*>(mempool_alloc(n*sizeof(Real)))) {}
+        ~InterpScratch () { mempool_free(m_ptr); }
+        Real* dataPtr () { return m_ptr; }
+    private:
+        Real* m_ptr;
+        InterpScratch (const InterpScratch&);
+        InterpScratch& operator= (const InterpScratch&);
+    };
+}
+
 Interpolater::~Interpolater () {}
 
 InterpolaterBoxCoarsener
@@ -44,6 +67,14 @@ InterpolaterBoxCoarsener::clone () const
     return new InterpolaterBoxCoarsener(mapper, ratio);
 }
 
+bool
+InterpolaterBoxCoarsener::operator== (const BoxConverter& rhs) const
+{
+    const InterpolaterBoxCoarsener* p = dynamic_cast<const InterpolaterBoxCoarsener*>(&rhs);
+
+    return p != 0 && p->mapper == mapper && p->ratio == ratio;
+}
+
 NodeBilinear::~NodeBilinear () {}
 
 Box
@@ -191,13 +222,6 @@ CellBilinear::interp (const FArrayBox&  crse,
 
     Array<Real> slope(slp_len);
 
-    int strp_len = len0*ratio[0];
-
-    Array<Real> strip(strp_len);
-
-    int strip_lo = ratio[0] * clo[0];
-    int strip_hi = ratio[0] * chi[0];
-
     const Real* cdat  = crse.dataPtr(crse_comp);
     Real*       fdat  = fine.dataPtr(fine_comp);
     const int* ratioV = ratio.getVect();
@@ -205,7 +229,7 @@ CellBilinear::interp (const FArrayBox&  crse,
     FORT_CBINTERP (cdat,ARLIM(clo),ARLIM(chi),ARLIM(clo),ARLIM(chi),
                    fdat,ARLIM(flo),ARLIM(fhi),ARLIM(lo),ARLIM(hi),
                    D_DECL(&ratioV[0],&ratioV[1],&ratioV[2]),&ncomp,
-                   slope.dataPtr(),&num_slope,strip.dataPtr(),&strip_lo,&strip_hi,
+                   slope.dataPtr(),&num_slope,
                    &actual_comp,&actual_state);
 }
 
@@ -307,28 +331,42 @@ CellConservativeLinear::interp (const FArrayBox& crse,
     // --> there is a slope for each component in each coordinate 
     //     direction
     //
-    FArrayBox ucc_slopes(cslope_bx,ncomp*BL_SPACEDIM);
-    FArrayBox lcc_slopes(cslope_bx,ncomp*BL_SPACEDIM);
-    FArrayBox slope_factors(cslope_bx,BL_SPACEDIM);
+    // All of it, and the fine volume offsets, is carved out of a single
+    // block of pool memory.
+    //
+    const long npts = cslope_bx.numPts();
 
-    FArrayBox  cmax(cslope_bx,ncomp);
-    FArrayBox  cmin(cslope_bx,ncomp);
-    FArrayBox alpha(cslope_bx,ncomp);
+    long nscratch = npts*(2*ncomp*BL_SPACEDIM + BL_SPACEDIM + 3*ncomp);
+    for (dir = 0; dir < BL_SPACEDIM; dir++)
+        nscratch += fvc[dir].size();
+
+    InterpScratch scratch(nscratch);
+
+    Real* ucc_slopes    = scratch.dataPtr();
+    Real* lcc_slopes    = ucc_slopes    + npts*ncomp*BL_SPACEDIM;
+    Real* slope_factors = lcc_slopes    + npts*ncomp*BL_SPACEDIM;
+    Real* cmax          = slope_factors + npts*BL_SPACEDIM;
+    Real* cmin          = cmax          + npts*ncomp;
+    Real* alpha         = cmin          + npts*ncomp;
+
+    D_TERM(Real* voffx = alpha + npts*ncomp;,
+           Real* voffy = voffx + fvc[0].size();,
+           Real* voffz = voffy + fvc[1].size(););
 
     Real* fdat       = fine.dataPtr(fine_comp);
     const Real* cdat = crse.dataPtr(crse_comp);
-    Real* ucc_xsldat = ucc_slopes.dataPtr(0);
-    Real* lcc_xsldat = lcc_slopes.dataPtr(0);
-    Real* xslfac_dat = slope_factors.dataPtr(0);
+    Real* ucc_xsldat = ucc_slopes;
+    Real* lcc_xsldat = lcc_slopes;
+    Real* xslfac_dat = slope_factors;
 #if (BL_SPACEDIM>=2)
-    Real* ucc_ysldat = ucc_slopes.dataPtr(ncomp);
-    Real* lcc_ysldat = lcc_slopes.dataPtr(ncomp);
-    Real* yslfac_dat = slope_factors.dataPtr(1);
+    Real* ucc_ysldat = ucc_slopes    + npts*ncomp;
+    Real* lcc_ysldat = lcc_slopes    + npts*ncomp;
+    Real* yslfac_dat = slope_factors + npts;
 #endif
 #if (BL_SPACEDIM==3)
-    Real* ucc_zsldat = ucc_slopes.dataPtr(2*ncomp);
-    Real* lcc_zsldat = lcc_slopes.dataPtr(2*ncomp);
-    Real* zslfac_dat = slope_factors.dataPtr(2);
+    Real* ucc_zsldat = ucc_slopes    + 2*npts*ncomp;
+    Real* lcc_zsldat = lcc_slopes    + 2*npts*ncomp;
+    Real* zslfac_dat = slope_factors + 2*npts;
 #endif
     
     const int* flo    = fine.loVect();
@@ -353,10 +391,6 @@ CellConservativeLinear::interp (const FArrayBox& crse,
         fvcbhi[dir] = fvcblo[dir] + fvc[dir].size() - 1;
     }
 
-    D_TERM(Real* voffx = new Real[fvc[0].size()];,
-           Real* voffy = new Real[fvc[1].size()];,
-           Real* voffz = new Real[fvc[2].size()];);
-
     Array<int> bc     = GetBCArray(bcr);
     const int* ratioV = ratio.getVect();
 
@@ -379,11 +413,9 @@ CellConservativeLinear::interp (const FArrayBox& crse,
                       D_DECL(fvc[0].dataPtr(),fvc[1].dataPtr(),fvc[2].dataPtr()),
                       D_DECL(cvc[0].dataPtr(),cvc[1].dataPtr(),cvc[2].dataPtr()),
                       D_DECL(voffx,voffy,voffz),
-                      alpha.dataPtr(),cmax.dataPtr(),cmin.dataPtr(),
+                      alpha,cmax,cmin,
                       &actual_comp,&actual_state);
 
-    D_TERM(delete [] voffx;, delete [] voffy;, delete [] voffz;);
-
 }
 
 CellQuadratic::CellQuadratic (bool limit)
@@ -558,11 +590,16 @@ PCInterp::interp (const FArrayBox& crse,
     const int* cblo = cregion.loVect();
     const int* cbhi = cregion.hiVect();
 
-    int long_dir;
-    int long_len = cregion.longside(long_dir);
+    //
+    // Always use strips in the x direction: the kernel then runs unit
+    // stride through the fine data, which is worth more than the shorter
+    // trip count we'd get from the longest side.
+    //
+    int long_dir = 0;
+    int long_len = cregion.length(long_dir);
     int s_len    = long_len*ratio[long_dir];
 
-    Array<Real> strip(s_len);
+    InterpScratch strip(s_len);
 
     int strip_lo = ratio[long_dir] * cblo[long_dir];
     int strip_hi = ratio[long_dir] * (cbhi[long_dir]+1) - 1;
@@ -655,28 +692,42 @@ CellConservativeProtected::interp (const FArrayBox& crse,
     // --> there is a slope for each component in each coordinate 
     //     direction
     //
-    FArrayBox ucc_slopes(cslope_bx,ncomp*BL_SPACEDIM);
-    FArrayBox lcc_slopes(cslope_bx,ncomp*BL_SPACEDIM);
-    FArrayBox slope_factors(cslope_bx,BL_SPACEDIM);
+    // All of it, and the fine volume offsets, is carved out of a single
+    // block of pool memory.
+    //
+    const long npts = cslope_bx.numPts();
+
+    long nscratch = npts*(2*ncomp*BL_SPACEDIM + BL_SPACEDIM + 3*ncomp);
+    for (dir = 0; dir < BL_SPACEDIM; dir++)
+        nscratch += fvc[dir].size();
+
+    InterpScratch scratch(nscratch);
 
-    FArrayBox  cmax(cslope_bx,ncomp);
-    FArrayBox  cmin(cslope_bx,ncomp);
-    FArrayBox alpha(cslope_bx,ncomp);
+    Real* ucc_slopes    = scratch.dataPtr();
+    Real* lcc_slopes    = ucc_slopes    + npts*ncomp*BL_SPACEDIM;
+    Real* slope_factors = lcc_slopes    + npts*ncomp*BL_SPACEDIM;
+    Real* cmax          = slope_factors + npts*BL_SPACEDIM;
+    Real* cmin          = cmax          + npts*ncomp;
+    Real* alpha         = cmin          + npts*ncomp;
+
+    D_TERM(Real* voffx = alpha + npts*ncomp;,
+           Real* voffy = voffx + fvc[0].size();,
+           Real* voffz = voffy + fvc[1].size(););
 
     Real* fdat       = fine.dataPtr(fine_comp);
     const Real* cdat = crse.dataPtr(crse_comp);
-    Real* ucc_xsldat = ucc_slopes.dataPtr(0);
-    Real* lcc_xsldat = lcc_slopes.dataPtr(0);
-    Real* xslfac_dat = slope_factors.dataPtr(0);
+    Real* ucc_xsldat = ucc_slopes;
+    Real* lcc_xsldat = lcc_slopes;
+    Real* xslfac_dat = slope_factors;
 #if (BL_SPACEDIM>=2)
-    Real* ucc_ysldat = ucc_slopes.dataPtr(ncomp);
-    Real* lcc_ysldat = lcc_slopes.dataPtr(ncomp);
-    Real* yslfac_dat = slope_factors.dataPtr(1);
+    Real* ucc_ysldat = ucc_slopes    + npts*ncomp;
+    Real* lcc_ysldat = lcc_slopes    + npts*ncomp;
+    Real* yslfac_dat = slope_factors + npts;
 #endif
 #if (BL_SPACEDIM==3)
-    Real* ucc_zsldat = ucc_slopes.dataPtr(2*ncomp);
-    Real* lcc_zsldat = lcc_slopes.dataPtr(2*ncomp);
-    Real* zslfac_dat = slope_factors.dataPtr(2);
+    Real* ucc_zsldat = ucc_slopes    + 2*npts*ncomp;
+    Real* lcc_zsldat = lcc_slopes    + 2*npts*ncomp;
+    Real* zslfac_dat = slope_factors + 2*npts;
 #endif
     
     const int* flo    = fine.loVect();
@@ -700,10 +751,6 @@ CellConservativeProtected::interp (const FArrayBox& crse,
         fvcbhi[dir] = fvcblo[dir] + fvc[dir].size() - 1;
     }
 
-    D_TERM(Real* voffx = new Real[fvc[0].size()];,
-           Real* voffy = new Real[fvc[1].size()];,
-           Real* voffz = new Real[fvc[2].size()];);
-
     Array<int> bc     = GetBCArray(bcr);
     const int* ratioV = ratio.getVect();
     int slope_flag    = 1;
@@ -727,11 +774,9 @@ CellConservativeProtected::interp (const FArrayBox& crse,
                       D_DECL(fvc[0].dataPtr(),fvc[1].dataPtr(),fvc[2].dataPtr()),
                       D_DECL(cvc[0].dataPtr(),cvc[1].dataPtr(),cvc[2].dataPtr()),
                       D_DECL(voffx,voffy,voffz),
-                      alpha.dataPtr(),cmax.dataPtr(),cmin.dataPtr(),
+                      alpha,cmax,cmin,
                       &actual_comp,&actual_state);
 
-    D_TERM(delete [] voffx;, delete [] voffy;, delete [] voffz;);
-
 #endif /*(BL_SPACEDIM > 1)*/
 }
 
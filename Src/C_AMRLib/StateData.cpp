@@ -17,6 +17,8 @@ const Real INVALID_TIME = -1.0e200;
 const int MFNEWDATA = 0;
 const int MFOLDDATA = 1;
 
+bool StateData::pooled = false;
+
 StateData::StateData () 
 {
    desc = 0;
@@ -144,7 +146,8 @@ StateData::copyOld (const StateData& state)
 {
 
   BL_ASSERT(state.hasOldData());
-  BL_ASSERT(old_data != 0);
+
+  allocOldData();
 
   const MultiFab& MF = state.oldData();
 
@@ -317,17 +320,122 @@ StateData::~StateData()
    desc = 0;
    delete new_data;
    delete old_data;
+   for (int i = 0; i < numStages(); i++)
+       delete stage_data[i];
+   for (std::vector<MultiFab*>::size_type i = 0; i < spare_data.size(); i++)
+       delete spare_data[i];
+}
+
+MultiFab*
+StateData::takeSpare (int ngrow)
+{
+    //
+    // Use the layout of the new data so all our MultiFabs can be swapped.
+    //
+    BL_ASSERT(new_data != 0);
+
+    const DistributionMapping& dm = new_data->DistributionMap();
+
+    MultiFab* mf = 0;
+
+    for (std::vector<MultiFab*>::size_type i = 0; i < spare_data.size(); )
+    {
+        if (spare_data[i]->boxArray() != grids || spare_data[i]->DistributionMap() != dm)
+        {
+            //
+            // Left behind by a change of layout.
+            //
+            delete spare_data[i];
+            spare_data.erase(spare_data.begin() + i);
+        }
+        else if (mf == 0 && spare_data[i]->nGrow() == ngrow)
+        {
+            mf = spare_data[i];
+            spare_data.erase(spare_data.begin() + i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    if (mf == 0)
+        mf = new MultiFab(grids,desc->nComp(),ngrow,dm);
+
+    return mf;
+}
+
+void
+StateData::giveSpare (MultiFab* mf)
+{
+    if (mf == 0) return;
+
+    if (pooled                                                &&
+        new_data != 0                                         &&
+        mf->boxArray()        == grids                        &&
+        mf->DistributionMap() == new_data->DistributionMap()  &&
+        mf->nComp()           == desc->nComp())
+    {
+        spare_data.push_back(mf);
+    }
+    else
+    {
+        delete mf;
+    }
 }
 
 void
 StateData::allocOldData ()
 {
     if (old_data == 0)
+        old_data = takeSpare(desc->nExtra());
+}
+
+void
+StateData::removeOldData ()
+{
+    giveSpare(old_data);
+    old_data = 0;
+}
+
+void
+StateData::allocStageData (int nstage,
+                           int ngrow)
+{
+    BL_ASSERT(nstage >= 0);
+
+    if (ngrow < 0) ngrow = desc->nExtra();
+
+    if (numStages() > 0 && stage_data[0]->nGrow() != ngrow)
+        removeStageData();
+
+    for (int i = numStages(); i < nstage; i++)
     {
-        old_data = new MultiFab(grids,desc->nComp(),desc->nExtra());
+        stage_data.push_back(takeSpare(ngrow));
     }
 }
 
+void
+StateData::removeStageData ()
+{
+    for (int i = 0; i < numStages(); i++)
+        giveSpare(stage_data[i]);
+
+    stage_data.clear();
+}
+
+void
+StateData::swapStageData (int i)
+{
+    BL_ASSERT(i >= 0 && i < numStages());
+    BL_ASSERT(new_data != 0);
+    BL_ASSERT(stage_data[i]->boxArray() == new_data->boxArray());
+    BL_ASSERT(stage_data[i]->DistributionMap() == new_data->DistributionMap());
+    BL_ASSERT(stage_data[i]->nGrow() == new_data->nGrow());
+
+    std::swap(new_data, stage_data[i]);
+}
+
 BCRec
 StateData::getBC (int comp, int i) const
 {
@@ -402,14 +510,14 @@ void
 StateData::replaceOldData (MultiFab* mf)
 {
     std::swap(old_data, mf);
-    delete mf;
+    giveSpare(mf);
 }
 
 void
 StateData::replaceNewData (MultiFab* mf)
 {
     std::swap(new_data, mf);
-    delete mf;
+    giveSpare(mf);
 }
 
 void
@@ -632,6 +632,74 @@ TagBoxArray::collate (long& numtags) const
     return TheGlobalCollateSpace;
 }
 
+IntVect*
+TagBoxArray::collateLocal (long&    numtags,
+                           BoxList& region) const
+{
+    BL_PROFILE("TagBoxArray::collateLocal()");
+
+    region.clear();
+    //
+    // Gather all tags (including those in ghost cells) onto the full
+    // fabbox of every box, so that overlapping boxes see the same tags.
+    //
+    BoxArray gba(boxArray());
+    gba.grow(n_grow);
+
+    FabArray<TagBox> tmp(gba,1,0,DistributionMap());  // filled w/ CLEAR.
+
+    tmp.copy(*this,0,0,1,n_grow,0,FabArrayBase::ADD);
+    //
+    // A cell belongs to the lowest-numbered box whose fabbox contains it.
+    //
+    std::vector<BoxList> owned(tmp.local_size());
+
+    int count = 0;
+
+    for (MFIter mfi(tmp); mfi.isValid(); ++mfi)
+    {
+        const int  i  = mfi.index();
+        const Box& bx = gba[i];
+
+        BoxList lower(bx.ixType());
+        std::vector< std::pair<int,Box> > isects;
+        gba.intersections(bx,isects);
+        for (int j = 0, N = isects.size(); j < N; j++)
+            if (isects[j].first < i)
+                lower.push_back(isects[j].second);
+
+        BoxList& bl = owned[mfi.LocalIndex()];
+        if (lower.isEmpty())
+            bl.push_back(bx);
+        else
+            bl.complementIn(bx,lower);
+
+        for (BoxList::const_iterator it = bl.begin(); it != bl.end(); ++it)
+            count += tmp[mfi].numTags(*it);
+    }
+
+    IntVect* TheLocalCollateSpace = new IntVect[count];
+
+    count = 0;
+
+    for (MFIter mfi(tmp); mfi.isValid(); ++mfi)
+    {
+        const BoxList& bl = owned[mfi.LocalIndex()];
+
+        for (BoxList::const_iterator it = bl.begin(); it != bl.end(); ++it)
+        {
+            TagBox tb(*it,1);
+            tb.copy(tmp[mfi]);
+            count += tb.collate(TheLocalCollateSpace,count);
+            region.push_back(*it);
+        }
+    }
+
+    numtags = count;
+
+    return TheLocalCollateSpace;
+}
+
 void
 TagBoxArray::setVal (const BoxList& bl,
                      TagBox::TagVal val)
@@ -7,6 +7,7 @@
 #include <BaseFab.H>
 #include <BArena.H>
 #include <CArena.H>
+#include <SArena.H>
 
 #if !(defined(BL_NO_FORT) || defined(WIN32))
 #include <SPECIALIZE_F.H>
@@ -36,6 +37,8 @@ BoxLib::BF_init::BF_init ()
 
 #if defined(BL_COALESCE_FABS)
         the_arena = new CArena;
+#elif defined(BL_SIZE_CLASS_FABS)
+        the_arena = new SArena;
 #else
         the_arena = new BArena;
 #endif
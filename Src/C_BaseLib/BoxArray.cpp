@@ -15,10 +15,6 @@ long BoxArray::Ref::total_hash_bytes     = 0L;
 long BoxArray::Ref::total_hash_bytes_hwm = 0L;
 #endif
 
-typedef std::map< IntVect,std::vector<int>,IntVect::Compare > BoxHashMapType;
-typedef std::map< IntVect,std::vector<int>,IntVect::Compare >::iterator BoxHashMapIter;
-typedef std::map< IntVect,std::vector<int>,IntVect::Compare >::const_iterator ConstBoxHashMapIter;
-
 void
 BoxArray::decrementCounters () const
 {
@@ -93,8 +89,14 @@ BoxArray::operator= (const BoxArray& rhs)
 void
 BoxArray::uniqify ()
 {
-    BL_ASSERT(!m_ref.unique());
-    m_ref = new BoxArray::Ref(*m_ref);
+    if (!m_ref.unique())
+        m_ref = new BoxArray::Ref(*m_ref);
+    //
+    // The boxes are about to change, so the hash table and the content
+    // hash of a Ref we had to ourselves are stale.
+    //
+    clear_hash_bin();
+    m_ref->content_hash = 0;
 }
 
 long
@@ -124,8 +126,7 @@ BoxArray::clear ()
 void
 BoxArray::resize (long len)
 {
-    if (!m_ref.unique())
-        uniqify();
+    uniqify();
     m_ref->resize(len);
 }
 
@@ -134,8 +135,7 @@ BoxArray::set (int        i,
                const Box& ibox)
 {
     if (i == 0) m_typ = ibox.ixType();
-    if (!m_ref.unique())
-        uniqify();
+    uniqify();
     m_ref->m_abox.set(i, BoxLib::enclosedCells(ibox));
 }
 
@@ -267,8 +267,7 @@ BoxArray::CellEqual (const BoxArray& rhs) const
 BoxArray&
 BoxArray::refine (int refinement_ratio)
 {
-    if (!m_ref.unique())
-        uniqify();
+    uniqify();
     const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -281,8 +280,7 @@ BoxArray::refine (int refinement_ratio)
 BoxArray&
 BoxArray::refine (const IntVect& iv)
 {
-    if (!m_ref.unique())
-        uniqify();
+    uniqify();
     const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -296,8 +294,7 @@ BoxArray&
 BoxArray::shift (int dir,
                  int nzones)
 {
-    if (!m_ref.unique())
-        uniqify();
+    uniqify();
     const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -311,8 +308,7 @@ BoxArray::shift (int dir,
 BoxArray&
 BoxArray::shift (const IntVect& iv)
 {
-    if (!m_ref.unique())
-        uniqify();
+    uniqify();
     const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -326,8 +322,7 @@ BoxArray&
 BoxArray::shiftHalf (int dir,
                      int num_halfs)
 {
-    if (!m_ref.unique())
-        uniqify();
+    uniqify();
     const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -340,8 +335,7 @@ BoxArray::shiftHalf (int dir,
 BoxArray&
 BoxArray::shiftHalf (const IntVect& iv)
 {
-    if (!m_ref.unique())
-        uniqify();
+    uniqify();
     const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -354,8 +348,7 @@ BoxArray::shiftHalf (const IntVect& iv)
 BoxArray&
 BoxArray::coarsen (int refinement_ratio)
 {
-    if (!m_ref.unique())
-        uniqify();
+    uniqify();
     const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -368,8 +361,7 @@ BoxArray::coarsen (int refinement_ratio)
 BoxArray&
 BoxArray::coarsen (const IntVect& iv)
 {
-    if (!m_ref.unique())
-        uniqify();
+    uniqify();
     const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -382,8 +374,7 @@ BoxArray::coarsen (const IntVect& iv)
 BoxArray&
 BoxArray::growcoarsen (int n, const IntVect& iv)
 {
-    if (!m_ref.unique())
-        uniqify();
+    uniqify();
     const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -396,8 +387,7 @@ BoxArray::growcoarsen (int n, const IntVect& iv)
 BoxArray&
 BoxArray::grow (int n)
 {
-    if (!m_ref.unique())
-        uniqify();
+    uniqify();
     const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -410,8 +400,7 @@ BoxArray::grow (int n)
 BoxArray&
 BoxArray::grow (const IntVect& iv)
 {
-    if (!m_ref.unique())
-        uniqify();
+    uniqify();
     const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -425,8 +414,7 @@ BoxArray&
 BoxArray::grow (int dir,
                 int n_cell)
 {
-    if (!m_ref.unique())
-        uniqify();
+    uniqify();
     const int N = m_ref->m_abox.size();
 #ifdef _OPENMP
 #pragma omp parallel for
@@ -536,8 +524,7 @@ BoxArray::convert (Box (*fp)(const Box&))
 {
     BL_ASSERT(!(fp == 0));
 
-    if (!m_ref.unique())
-        uniqify();
+    uniqify();
     const int N = size();
     for (int i = 0; i < N; ++i)
 	set(i,fp(get(i)));
@@ -823,12 +810,14 @@ BoxLib::GetBndryCells (const BoxArray& ba,
 void
 BoxArray::clear_hash_bin () const
 {
-    if (!m_ref->hash.empty())
+    if (m_ref->hash_built)
     {
 #ifdef BL_MEM_PROFILING
 	m_ref->updateMemoryUsage_hash(-1);
 #endif
-        m_ref->hash.clear();
+        m_ref->hash_built = false;
+        Array<int>().swap(m_ref->hash_off);
+        Array<int>().swap(m_ref->hash_idx);
     }
 }
 
@@ -895,41 +884,85 @@ BoxArray::intersections (const Box&                         bx,
 {
     // called too many times  BL_PROFILE("BoxArray::intersections()");
 
-    BoxHashMapType& BoxHashMap = getHashMap();
+    build_hash_bin();
 
     isects.resize(0);
 
-    if (!BoxHashMap.empty())
+    add_intersections(bx, isects, first_only, ng);
+}
+
+void
+BoxArray::intersections (const Array<Box>&                  bxs,
+                         std::vector< std::pair<int,Box> >& isects,
+                         std::vector<int>&                  offset,
+                         int                                ng) const
+{
+    BL_PROFILE("BoxArray::intersections(Array<Box>)");
+
+    build_hash_bin();
+
+    const int N = bxs.size();
+
+    isects.resize(0);
+    offset.resize(N+1);
+
+    for (int i = 0; i < N; i++)
     {
-        BL_ASSERT(bx.ixType() == m_typ);
+        offset[i] = isects.size();
 
-        Box           cbx = BoxLib::coarsen(BoxLib::grow(bx,ng), m_ref->crsn);
-        const IntVect& sm = BoxLib::max(cbx.smallEnd()-1, m_ref->bbox.smallEnd());
-        const IntVect& bg = BoxLib::min(cbx.bigEnd(),     m_ref->bbox.bigEnd());
+        add_intersections(bxs[i], isects, false, ng);
+    }
 
-        cbx = Box(sm,bg);
+    offset[N] = isects.size();
+}
+
+void
+BoxArray::add_intersections (const Box&                         bx,
+                             std::vector< std::pair<int,Box> >& isects,
+                             bool                               first_only,
+                             int                                ng) const
+{
+    BL_ASSERT(m_ref->hash_built);
+
+    if (empty()) return;
+
+    BL_ASSERT(bx.ixType() == m_typ);
+
+    const Box&        bb  = m_ref->bbox;
+    const int*        off = m_ref->hash_off.dataPtr();
+    const int*        idx = m_ref->hash_idx.dataPtr();
+    const Array<Box>& abx = m_ref->m_abox;
+    const bool        cc  = m_typ.cellCentered();
+    //
+    // A box can only stick out of its bin into the bins above it.
+    //
+    Box           cbx = BoxLib::coarsen(BoxLib::grow(bx,ng), m_ref->crsn);
+    const IntVect& sm = BoxLib::max(cbx.smallEnd()-1, bb.smallEnd());
+    const IntVect& bg = BoxLib::min(cbx.bigEnd(),     bb.bigEnd());
+
+    if (!(sm <= bg)) return;
+    //
+    // The bins in a row are contiguous, and so are their boxes.
+    //
+    const int nx = bg[0] - sm[0] + 1;
+
+    Box rows(sm,bg);
+
+    rows.setBig(0,sm[0]);
 
-        ConstBoxHashMapIter TheEnd = BoxHashMap.end();
+    for (IntVect iv = rows.smallEnd(), End = rows.bigEnd(); iv <= End; rows.next(iv))
+    {
+        const long b = bb.index(iv);
 
-        for (IntVect iv = cbx.smallEnd(), End = cbx.bigEnd(); iv <= End; cbx.next(iv))
+        for (int k = off[b], kend = off[b+nx]; k < kend; k++)
         {
-            ConstBoxHashMapIter it = BoxHashMap.find(iv);
+            const int  index = idx[k];
+            const Box& isect = bx & BoxLib::grow(cc ? abx[index] : get(index),ng);
 
-            if (it != TheEnd)
+            if (isect.ok())
             {
-                for (std::vector<int>::const_iterator v_it = it->second.begin(), v_end = it->second.end();
-                     v_it != v_end;
-                     ++v_it)
-                {
-                    const int  index = *v_it;
-                    const Box& isect = bx & BoxLib::grow(get(index),ng);
-
-                    if (isect.ok())
-                    {
-                        isects.push_back(std::pair<int,Box>(index,isect));
-			if (first_only) return;
-                    }
-                }
+                isects.push_back(std::pair<int,Box>(index,isect));
+                if (first_only) return;
             }
         }
     }
@@ -942,41 +975,40 @@ BoxArray::complement (const Box& bx) const
 
     if (!empty()) 
     {
-	BoxHashMapType& BoxHashMap = getHashMap();
+        build_hash_bin();
 
 	BL_ASSERT(bx.ixType() == m_typ);
 
+        const Box& bb  = m_ref->bbox;
+        const int* off = m_ref->hash_off.dataPtr();
+        const int* idx = m_ref->hash_idx.dataPtr();
+
 	Box           cbx = BoxLib::coarsen(bx, m_ref->crsn);
-        const IntVect& sm = BoxLib::max(cbx.smallEnd()-1, m_ref->bbox.smallEnd());
-        const IntVect& bg = BoxLib::min(cbx.bigEnd(),     m_ref->bbox.bigEnd());
+        const IntVect& sm = BoxLib::max(cbx.smallEnd()-1, bb.smallEnd());
+        const IntVect& bg = BoxLib::min(cbx.bigEnd(),     bb.bigEnd());
 
-        cbx = Box(sm,bg);
+        if (!(sm <= bg)) return bl;
 
-        ConstBoxHashMapIter TheEnd = BoxHashMap.end();
+        cbx = Box(sm,bg);
 
 	for (IntVect iv = cbx.smallEnd(), End = cbx.bigEnd(); 
 	     iv <= End && bl.isNotEmpty(); 
 	     cbx.next(iv))
         {
-            ConstBoxHashMapIter it = BoxHashMap.find(iv);
+            const long b = bb.index(iv);
 
-            if (it != TheEnd)
+            for (int k = off[b]; k < off[b+1] && bl.isNotEmpty(); k++)
             {
-                for (std::vector<int>::const_iterator v_it = it->second.begin(), v_end = it->second.end(); 
-		     v_it != v_end && bl.isNotEmpty(); 
-		     ++v_it)
-                {
-                    const int  index = *v_it;
-                    const Box& isect = bx & get(index);
+                const int  index = idx[k];
+                const Box& isect = bx & get(index);
 
-                    if (isect.ok())
+                if (isect.ok())
+                {
+                    for (BoxList::iterator bli = bl.begin(); bli != bl.end(); )
                     {
-			for (BoxList::iterator bli = bl.begin(); bli != bl.end(); )
-			{
-			    BoxList diff = BoxLib::boxDiff(*bli, isect);
-			    bl.splice_front(diff);
-			    bl.remove(bli++);
-			}
+                        BoxList diff = BoxLib::boxDiff(*bli, isect);
+                        bl.splice_front(diff);
+                        bl.remove(bli++);
                     }
                 }
             }
@@ -986,48 +1018,88 @@ BoxArray::complement (const Box& bx) const
     return bl;
 }
 
-BoxArray::BoxHashMapType&
-BoxArray::getHashMap () const
+void
+BoxArray::build_hash_bin () const
 {
-    BoxHashMapType& BoxHashMap = m_ref->hash;
+    //
+    // Without C++11 atomics nothing orders the table before the flag for
+    // another thread, so with threads the flag is only read under the lock.
+    //
+#if defined(BL_USE_CXX11)
+    if (m_ref->hash_built.load(std::memory_order_acquire)) return;
+#elif !defined(_OPENMP)
+    if (m_ref->hash_built) return;
+#endif
 
 #ifdef _OPENMP
     #pragma omp critical(intersections_lock)
 #endif
+    if (!m_ref->hash_built)
     {
-        if (BoxHashMap.empty() && size() > 0)
+        const int N = size();
+
+        Box     boundingbox;
+        IntVect maxext = IntVect::TheUnitVector();
+
+        if (N > 0)
         {
             //
             // Calculate the bounding box & maximum extent of the boxes.
             //
-            Box boundingbox = BoxLib::surroundingNodes(m_ref->m_abox[0]);
-	    IntVect maxext = boundingbox.size();
+            boundingbox = BoxLib::surroundingNodes(m_ref->m_abox[0]);
+            maxext      = boundingbox.size();
 
-	    const int N = size();
-
-	    for (int i = 1; i < N; ++i)
+            for (int i = 1; i < N; ++i)
             {
                 const Box& bx = BoxLib::surroundingNodes(m_ref->m_abox[i]);
-		boundingbox.minBox(bx);
+                boundingbox.minBox(bx);
                 maxext = BoxLib::max(maxext, bx.size());
             }
+        }
+        //
+        // Bins at least as big as the biggest box mean a box overlaps at
+        // most its own bin and the ones above.  Don't let a sparse
+        // BoxArray blow up the number of bins.
+        //
+        Box bb = BoxLib::coarsen(boundingbox,maxext);
+
+        while (N > 0 && bb.d_numPts() > 8.0*N + 64)
+        {
+            maxext *= 2;
+            bb = BoxLib::coarsen(boundingbox,maxext);
+        }
 
-            boundingbox.coarsen(maxext);
+        const long NBins = (N > 0) ? bb.numPts() : 0;
 
-            m_ref->crsn = maxext;
-            m_ref->bbox = boundingbox;
+        Array<int> off(NBins+1,0), idx(N);
 
-            for (int i = 0; i < N; i++)
-            {
-                BoxHashMap[BoxLib::coarsen(m_ref->m_abox[i].smallEnd(),maxext)].push_back(i);
-            }
+        for (int i = 0; i < N; i++)
+            off[bb.index(BoxLib::coarsen(m_ref->m_abox[i].smallEnd(),maxext))+1]++;
+
+        for (long b = 0; b < NBins; b++)
+            off[b+1] += off[b];
+
+        std::vector<int> pos(off.begin(), off.end()-1);
+
+        for (int i = 0; i < N; i++)
+            idx[pos[bb.index(BoxLib::coarsen(m_ref->m_abox[i].smallEnd(),maxext))]++] = i;
+
+        m_ref->crsn = maxext;
+        m_ref->bbox = bb;
+        m_ref->hash_off.swap(off);
+        m_ref->hash_idx.swap(idx);
 #ifdef BL_MEM_PROFILING
-	    m_ref->updateMemoryUsage_hash(1);
+	m_ref->updateMemoryUsage_hash(1);
+#endif
+        //
+        // The table must be visible before anybody can see the flag.
+        //
+#ifdef BL_USE_CXX11
+        m_ref->hash_built.store(true, std::memory_order_release);
+#else
+        m_ref->hash_built = true;
 #endif
-        }
     }
-
-    return BoxHashMap;
 }
 
 //
@@ -1039,11 +1111,24 @@ BoxArray::removeOverlap ()
 {
     BL_ASSERT(m_typ.cellCentered());
 
-    if (!m_ref.unique()) uniqify();
+    uniqify();
+
+    build_hash_bin();
+    //
+    // We add Boxes as we go, so copy the hash table into bins we can add to.
+    //
+    const Box     bb   = m_ref->bbox;
+    const IntVect crsn = m_ref->crsn;
+
+    Array< std::vector<int> > bins(size() > 0 ? bb.numPts() : 0);
 
-    std::map< IntVect,std::vector<int>,IntVect::Compare >& BoxHashMap = m_ref->hash;
+    for (long b = 0; b < bins.size(); b++)
+    {
+        bins[b].assign(m_ref->hash_idx.begin() + m_ref->hash_off[b],
+                       m_ref->hash_idx.begin() + m_ref->hash_off[b+1]);
+    }
 
-    typedef std::map< IntVect,std::vector<int>,IntVect::Compare >::const_iterator ConstBoxHashMapIter;
+    clear_hash_bin();
 
     BoxList bl;
 
@@ -1055,14 +1140,33 @@ BoxArray::removeOverlap ()
     //
 #ifdef BL_MEM_PROFILING
     m_ref->updateMemoryUsage_box(-1);
-    m_ref->updateMemoryUsage_hash(-1);
-    long total_hash_bytes_save = m_ref->total_hash_bytes;
 #endif
     for (int i = 0; i < size(); i++)
     {
         if (m_ref->m_abox[i].ok())
         {
-            intersections(m_ref->m_abox[i],isects);
+            const Box bxi = m_ref->m_abox[i];
+
+            isects.resize(0);
+
+            Box           cbx = BoxLib::coarsen(bxi, crsn);
+            const IntVect& sm = BoxLib::max(cbx.smallEnd()-1, bb.smallEnd());
+            const IntVect& bg = BoxLib::min(cbx.bigEnd(),     bb.bigEnd());
+
+            cbx = Box(sm,bg);
+
+            for (IntVect iv = cbx.smallEnd(), End = cbx.bigEnd(); iv <= End; cbx.next(iv))
+            {
+                const std::vector<int>& bin = bins[bb.index(iv)];
+
+                for (int k = 0, M = bin.size(); k < M; k++)
+                {
+                    const Box& isect = bxi & m_ref->m_abox[bin[k]];
+
+                    if (isect.ok())
+                        isects.push_back(std::pair<int,Box>(bin[k],isect));
+                }
+            }
 
             for (int j = 0, N = isects.size(); j < N; j++)
             {
@@ -1078,7 +1182,7 @@ BoxArray::removeOverlap ()
                 {
                     m_ref->m_abox.push_back(*it);
 
-                    BoxHashMap[BoxLib::coarsen(it->smallEnd(),m_ref->crsn)].push_back(size()-1);
+                    bins[bb.index(BoxLib::coarsen(it->smallEnd(),crsn))].push_back(size()-1);
                 }
             }
         }
@@ -1091,26 +1195,15 @@ BoxArray::removeOverlap ()
     //
     bl.clear();
 
-    const Box& bb = m_ref->bbox;
-
-    ConstBoxHashMapIter TheEnd = BoxHashMap.end();
-
-    for (IntVect iv = bb.smallEnd(), End = bb.bigEnd(); iv <= End; bb.next(iv))
+    for (long b = 0; b < bins.size(); b++)
     {
-        ConstBoxHashMapIter it = BoxHashMap.find(iv);
-
-        if (it != TheEnd)
+        for (int k = 0, M = bins[b].size(); k < M; k++)
         {
-            for (std::vector<int>::const_iterator v_it = it->second.begin(), v_end = it->second.end();
-                 v_it != v_end;
-                 ++v_it)
-            {
-                const int index = *v_it;
+            const int index = bins[b][k];
 
-                if (m_ref->m_abox[index].ok())
-                {
-                    bl.push_back(m_ref->m_abox[index]);
-                }
+            if (m_ref->m_abox[index].ok())
+            {
+                bl.push_back(m_ref->m_abox[index]);
             }
         }
     }
@@ -1123,13 +1216,38 @@ BoxArray::removeOverlap ()
 
     *this = nba;
 
-#ifdef BL_MEM_PROFILING
-    m_ref->total_hash_bytes = total_hash_bytes_save;
-#endif
-
     BL_ASSERT(isDisjoint());
 }
 
+unsigned long
+BoxArray::contentHash () const
+{
+    if (m_ref->content_hash == 0)
+    {
+        unsigned long h = m_ref->m_abox.size();
+
+        for (int i = 0, N = m_ref->m_abox.size(); i < N; i++)
+        {
+            const Box& bx = m_ref->m_abox[i];
+
+            for (int d = 0; d < BL_SPACEDIM; d++)
+            {
+                BoxLib::HashCombine(h, bx.smallEnd(d));
+                BoxLib::HashCombine(h, bx.bigEnd(d));
+            }
+        }
+
+        m_ref->content_hash = (h == 0) ? 1 : h;
+    }
+
+    unsigned long h = m_ref->content_hash;
+
+    for (int d = 0; d < BL_SPACEDIM; d++)
+        BoxLib::HashCombine(h, m_typ.ixType(d));
+
+    return h;
+}
+
 ptrdiff_t 
 BoxArray::getRefID () const
 {
@@ -1242,12 +1360,8 @@ BoxArray::Ref::updateMemoryUsage_box (int s)
 void
 BoxArray::Ref::updateMemoryUsage_hash (int s)
 {
-    if (hash.size() > 0) {
-	long b = sizeof(hash);
-	for (auto&& x: hash) {
-	    b += BoxLib::gcc_map_node_extra_bytes
-		+ sizeof(IntVect) + BoxLib::bytesOf(x.second);
-	}
+    if (hash_built) {
+	long b = BoxLib::bytesOf(hash_off) + BoxLib::bytesOf(hash_idx);
 	if (s > 0) {
 	    total_hash_bytes += b;
 	    total_hash_bytes_hwm = std::max(total_hash_bytes_hwm, total_hash_bytes);
@@ -384,6 +384,8 @@ DistributionMapping::GetMap (const BoxArray& boxes)
 void
 DistributionMapping::ReplaceCachedProcessorMap (const Array<int>& newProcmapArray)
 {
+    m_ref->m_hash = 0;
+
     const int N(newProcmapArray.size());
     BL_ASSERT(m_ref->m_pmap.size() == N);
     BL_ASSERT(newProcmapArray.size() == N);
@@ -394,7 +396,7 @@ DistributionMapping::ReplaceCachedProcessorMap (const Array<int>& newProcmapArra
 
 }
 
-DistributionMapping::Ref::Ref () {}
+DistributionMapping::Ref::Ref () : m_hash(0) {}
 
 DistributionMapping::DistributionMapping ()
     :
@@ -423,7 +425,8 @@ DistributionMapping::operator= (const DistributionMapping& rhs)
 
 DistributionMapping::Ref::Ref (const Array<int>& pmap)
     :
-    m_pmap(pmap)
+    m_pmap(pmap),
+    m_hash(0)
 {}
 
 DistributionMapping::DistributionMapping (const Array<int>& pmap, 
@@ -439,7 +442,8 @@ DistributionMapping::DistributionMapping (const Array<int>& pmap,
 
 DistributionMapping::Ref::Ref (int len)
     :
-    m_pmap(len)
+    m_pmap(len),
+    m_hash(0)
 {}
 
 DistributionMapping::DistributionMapping (const BoxArray& boxes,
@@ -455,7 +459,8 @@ DistributionMapping::DistributionMapping (const BoxArray& boxes,
 
 DistributionMapping::Ref::Ref (const Ref& rhs)
     :
-    m_pmap(rhs.m_pmap)
+    m_pmap(rhs.m_pmap),
+    m_hash(0)
 {}
 
 DistributionMapping::DistributionMapping (const DistributionMapping& d1,
@@ -497,6 +502,8 @@ DistributionMapping::define (const BoxArray& boxes,
         m_ref->m_pmap.resize(boxes.size() + 1);
     }
 
+    m_ref->m_hash = 0;
+
     if ( ! GetMap(boxes))
     {
 	BL_ASSERT(m_BuildMap != 0);
@@ -506,6 +513,57 @@ DistributionMapping::define (const BoxArray& boxes,
     }
 }
 
+void
+DistributionMapping::define (const BoxArray&          boxes,
+                             const std::vector<long>& wgts,
+                             int                      nprocs)
+{
+    Initialize();
+
+    m_color = ParallelDescriptor::DefaultColor();
+    //
+    // The cache is keyed on the number of boxes, not on the weights, so a
+    // cached map can't be used here.  The weighted map is always built and
+    // then replaces any cached map of the same length.  Maps already handed
+    // out keep their own Ref.
+    //
+    m_ref = new Ref(boxes.size() + 1);
+
+    WeightedProcessorMap(boxes,wgts,nprocs);
+
+    m_Cache[std::make_pair(int(m_ref->m_pmap.size()),m_color.to_int())] = m_ref;
+}
+
+void
+DistributionMapping::WeightedProcessorMap (const BoxArray&          boxes,
+                                           const std::vector<long>& wgts,
+                                           int                      nprocs)
+{
+    BL_ASSERT(boxes.size() > 0);
+    BL_ASSERT(boxes.size() == int(wgts.size()));
+
+    Initialize();
+
+    switch (m_Strategy)
+    {
+    case KNAPSACK:
+        KnapSackProcessorMap(wgts,nprocs);
+        break;
+    case SFC:
+        SFCProcessorMap(boxes,wgts,nprocs);
+        break;
+    case PFC:
+        PFCProcessorMap(boxes,wgts,nprocs);
+        break;
+    default:
+        if (m_ref->m_pmap.size() != boxes.size() + 1)
+        {
+            m_ref->m_pmap.resize(boxes.size() + 1);
+        }
+	(this->*m_BuildMap)(boxes,nprocs);
+    }
+}
+
 void
 DistributionMapping::define (const Array<int>& pmap)
 {
@@ -516,6 +574,8 @@ DistributionMapping::define (const Array<int>& pmap)
 
     for (unsigned int i=0; i<pmap.size(); ++i)
         m_ref->m_pmap[i] = pmap[i];
+
+    m_ref->m_hash = 0;
 }
 
 DistributionMapping::~DistributionMapping () { }
@@ -563,6 +623,8 @@ DistributionMapping::RoundRobinDoIt (int                  nboxes,
                                      int                 /* nprocs */,
                                      std::vector<LIpair>* LIpairV)
 {
+    m_ref->m_hash = 0;
+
     int nprocs = ParallelDescriptor::NProcs(m_color);
 
     // If team is not use, we are going to treat it as a special case in which
@@ -573,7 +635,7 @@ DistributionMapping::RoundRobinDoIt (int                  nboxes,
 #if defined(BL_USE_TEAM)
     nteams = ParallelDescriptor::NTeams();
     nworkers = ParallelDescriptor::TeamSize();
-    if (ParallelDescriptor::NColors() > 1) 
+    if (ParallelDescriptor::NColors() > 1 || m_color != ParallelDescriptor::DefaultColor()) 
 	BoxLib::Abort("Team and color together are not supported yet");
 #endif
 
@@ -880,6 +942,8 @@ DistributionMapping::KnapSackDoIt (const std::vector<long>& wgts,
 {
     BL_PROFILE("DistributionMapping::KnapSackDoIt()");
 
+    m_ref->m_hash = 0;
+
     int nprocs = ParallelDescriptor::NProcs(m_color);
 
     // If team is not use, we are going to treat it as a special case in which
@@ -890,7 +954,7 @@ DistributionMapping::KnapSackDoIt (const std::vector<long>& wgts,
 #if defined(BL_USE_TEAM)
     nteams = ParallelDescriptor::NTeams();
     nworkers = ParallelDescriptor::TeamSize();
-    if (ParallelDescriptor::NColors() > 1) 
+    if (ParallelDescriptor::NColors() > 1 || m_color != ParallelDescriptor::DefaultColor()) 
 	BoxLib::Abort("Team and color together are not supported yet");
 #endif
 
@@ -1128,6 +1192,8 @@ DistributionMapping::SFCProcessorMapDoIt (const BoxArray&          boxes,
 {
     BL_PROFILE("DistributionMapping::SFCProcessorMapDoIt()");
 
+    m_ref->m_hash = 0;
+
     int nprocs = ParallelDescriptor::NProcs(m_color);
 
     int nteams = nprocs;
@@ -1135,7 +1201,7 @@ DistributionMapping::SFCProcessorMapDoIt (const BoxArray&          boxes,
 #if defined(BL_USE_TEAM)
     nteams = ParallelDescriptor::NTeams();
     nworkers = ParallelDescriptor::TeamSize();
-    if (ParallelDescriptor::NColors() > 1) 
+    if (ParallelDescriptor::NColors() > 1 || m_color != ParallelDescriptor::DefaultColor()) 
 	BoxLib::Abort("Team and color together are not supported yet");
 #else
     if (node_size > 0) {
@@ -1361,13 +1427,12 @@ DistributionMapping::RRSFCDoIt (const BoxArray&          boxes,
 {
     BL_PROFILE("DistributionMapping::RRSFCDoIt()");
 
+    m_ref->m_hash = 0;
+
 #if defined (BL_USE_TEAM)
     BoxLib::Abort("Team support is not implemented yet in RRSFC");
 #endif
 
-    if (ParallelDescriptor::NColors() > 1) 
-	BoxLib::Abort("RRSFCMap does not support multi colors");
-
     std::vector<SFCToken> tokens;
 
     const int nboxes = boxes.size();
@@ -1405,7 +1470,7 @@ DistributionMapping::RRSFCDoIt (const BoxArray&          boxes,
 
     // Distribute boxes using roundrobin
     for (int i = 0; i < nboxes; ++i) {
-	m_ref->m_pmap[i] = ord[i%nprocs];
+	m_ref->m_pmap[i] = ParallelDescriptor::Translate(ord[i%nprocs],m_color);
     }
     //
     // Set sentinel equal to our processor number.
@@ -1542,12 +1607,17 @@ DistributionMapping::PFCProcessorMapDoIt (const BoxArray&          boxes,
 {
     BL_PROFILE("DistributionMapping::PFCProcessorMapDoIt()");
 
+    m_ref->m_hash = 0;
+
 #if defined (BL_USE_TEAM)
     BoxLib::Abort("Team support is not implemented yet in PFC");
 #endif
 
-    if (ParallelDescriptor::NColors() > 1) 
-	BoxLib::Abort("PFCProcessorMap does not support multi colors");
+    //
+    // The proximity map and the cell counts are over all processes.
+    //
+    if (m_color != ParallelDescriptor::DefaultColor()) 
+	BoxLib::Abort("PFCProcessorMap does not support colors");
 
     std::vector< std::vector<int> > vec(nprocs);
     std::vector<PFCToken> tokens;
@@ -2742,6 +2812,27 @@ void DistributionMapping::ReadCheckPointHeader(const std::string &filename,
 }
 #endif
 
+unsigned long
+DistributionMapping::contentHash () const
+{
+    if (m_ref->m_hash == 0)
+    {
+        //
+        // Leave out the sentinel, which differs from CPU to CPU.
+        //
+        const int N = m_ref->m_pmap.size() - 1;
+
+        unsigned long h = N;
+
+        for (int i = 0; i < N; i++)
+            BoxLib::HashCombine(h, m_ref->m_pmap[i]);
+
+        m_ref->m_hash = (h == 0) ? 1 : h;
+    }
+
+    return m_ref->m_hash;
+}
+
 ptrdiff_t 
 DistributionMapping::getRefID () const
 {
@@ -9,6 +9,7 @@
 
 #include <Utility.H>
 #include <FabArray.H>
+#include <Geometry.H>
 #include <ParmParse.H>
 
 #ifdef BL_MEM_PROFILING
@@ -19,6 +20,7 @@
 // Set default values in Initialize()!!!
 //
 bool    FabArrayBase::do_async_sends;
+bool    FabArrayBase::fb_persistent;
 int     FabArrayBase::MaxComp;
 #if BL_SPACEDIM == 1
 IntVect FabArrayBase::mfiter_tile_size(1024000);
@@ -54,6 +56,148 @@ namespace
     //
     int fb_cache_max_size;
     int copy_cache_max_size;
+    //
+    // Byte budgets for the caches; zero or less means no budget.
+    //
+    long fb_cache_max_bytes;
+    long copy_cache_max_bytes;
+    long fpc_cache_max_bytes;
+    //
+    // The entries of the FillBoundary() and copy() caches with their keys,
+    // least recently used first.
+    //
+    std::list< std::pair<unsigned long,FabArrayBase::SI*> >  fb_lru;
+    std::list< std::pair<unsigned long,FabArrayBase::CPC*> > cpc_lru;
+    inline bool in_flight (const FabArrayBase::SI& si)
+    {
+        for (std::map<int,FabArrayBase::PersistentComm*>::const_iterator it = si.m_pers.begin(),
+                 End = si.m_pers.end(); it != End; ++it)
+        {
+            if (it->second->m_busy) return true;
+        }
+        return false;
+    }
+    inline bool in_flight (const FabArrayBase::CPC&)   { return false; }
+
+    //
+    // Makes the cache entry e the most recently used one.
+    //
+    template <class List, class Entry>
+    inline
+    void
+    TouchCacheEntry (List& lru, Entry& e)
+    {
+        lru.splice(lru.end(), lru, e.m_lru);
+    }
+    //
+    // Accounts for the newly built entry keep, then evicts the least
+    // recently used other entries until the cache fits in max_size
+    // entries and (if max_bytes > 0) max_bytes bytes.  Entries with
+    // communication in flight are never evicted.
+    //
+    template <class Cache, class List>
+    void
+    AddToCache (Cache&                    cache,
+                List&                     lru,
+                typename Cache::iterator  keep,
+                FabArrayBase::CacheStats& stats,
+                int                       max_size,
+                long                      max_bytes)
+    {
+        keep->second.m_lru   = lru.insert(lru.end(), std::make_pair(keep->first, &keep->second));
+        keep->second.m_bytes = keep->second.bytes();
+
+        stats.bytes    += keep->second.m_bytes;
+        stats.bytes_hwm = std::max(stats.bytes_hwm, stats.bytes);
+
+        typename List::iterator it = lru.begin();
+
+        while ((static_cast<long>(cache.size()) > max_size || (max_bytes > 0 && stats.bytes > max_bytes)) &&
+               it != lru.end())
+        {
+            if (it->second == &keep->second || in_flight(*it->second))
+            {
+                ++it;
+                continue;
+            }
+
+            stats.bytes -= it->second->m_bytes;
+            stats.recordErase(it->second->m_nuse);
+
+            std::pair<typename Cache::iterator,typename Cache::iterator> er_it = cache.equal_range(it->first);
+
+            for (typename Cache::iterator ci = er_it.first; ci != er_it.second; ++ci)
+            {
+                if (&ci->second == it->second)
+                {
+                    cache.erase(ci);
+                    break;
+                }
+            }
+
+            it = lru.erase(it);
+        }
+    }
+    //
+    // The shifts by which the periodic images of src intersect target.
+    // The period is zero in the non-periodic directions.  See
+    // Geometry::periodicShift().
+    //
+    void
+    PeriodicShifts (const Box&            target,
+                    const Box&            src,
+                    const IntVect&        period,
+                    std::vector<IntVect>& out)
+    {
+        out.clear();
+
+        IntVect lo(IntVect::TheZeroVector()), hi(IntVect::TheZeroVector());
+
+        for (int dir = 0; dir < BL_SPACEDIM; ++dir)
+        {
+            if (period[dir] > 0)
+            {
+                lo[dir] = -1;
+                hi[dir] =  1;
+            }
+        }
+
+        const Box shifts(lo,hi);
+
+        for (IntVect iv = shifts.smallEnd(); iv <= shifts.bigEnd(); shifts.next(iv))
+        {
+            if (iv == IntVect::TheZeroVector()) continue;
+
+            IntVect sh;
+            for (int dir = 0; dir < BL_SPACEDIM; ++dir)
+                sh[dir] = iv[dir]*period[dir];
+
+            if (target.intersects(src+sh))
+                out.push_back(sh);
+        }
+    }
+    //
+    // Geometry::FillPeriodicBoundary() with corners also fills the ghost
+    // cells beyond the non-periodic faces of the domain.
+    //
+    void
+    GrowCorners (Box&           bx,
+                 const Box&     dstbx,
+                 const Box&     domain,
+                 const IntVect& period,
+                 int            ng)
+    {
+        for (int dir = 0; dir < BL_SPACEDIM; ++dir)
+        {
+            if (period[dir] == 0)
+            {
+                if (bx.smallEnd(dir) == domain.smallEnd(dir) && dstbx.smallEnd(dir) == domain.smallEnd(dir))
+                    bx.growLo(dir,ng);
+                if (bx.bigEnd(dir) == domain.bigEnd(dir) && dstbx.bigEnd(dir) == domain.bigEnd(dir))
+                    bx.growHi(dir,ng);
+            }
+        }
+    }
 }
 
 void
@@ -64,11 +208,16 @@ FabArrayBase::Initialize ()
     // Set default values here!!!
     //
     FabArrayBase::do_async_sends    = true;
+    FabArrayBase::fb_persistent     = true;
     FabArrayBase::MaxComp           = 25;
 
     copy_cache_max_size = 25;
     fb_cache_max_size   = 25;
 
+    copy_cache_max_bytes = 0;
+    fb_cache_max_bytes   = 0;
+    fpc_cache_max_bytes  = 0;
+
     ParmParse pp("fabarray");
 
     Array<int> tilesize(BL_SPACEDIM);
@@ -90,8 +239,12 @@ FabArrayBase::Initialize ()
 
     pp.query("maxcomp",             FabArrayBase::MaxComp);
     pp.query("do_async_sends",      FabArrayBase::do_async_sends);
+    pp.query("fb_persistent",       FabArrayBase::fb_persistent);
     pp.query("fb_cache_max_size",   fb_cache_max_size);
     pp.query("copy_cache_max_size", copy_cache_max_size);
+    pp.query("fb_cache_max_bytes",   fb_cache_max_bytes);
+    pp.query("copy_cache_max_bytes", copy_cache_max_bytes);
+    pp.query("fpc_cache_max_bytes",  fpc_cache_max_bytes);
     //
     // Don't let the caches get too small. This simplifies some logic later.
     //
@@ -209,9 +362,111 @@ FabArrayBase::SI::bytes () const
     if (m_RcvVols)
 	cnt += BoxLib::bytesOf(*m_RcvVols);
 
+    if (m_SndMsgTags)
+	cnt += BoxLib::bytesOf(*m_SndMsgTags);
+
+    if (m_RcvMsgTags)
+	cnt += BoxLib::bytesOf(*m_RcvMsgTags);
+
+    if (m_LocSched)
+	cnt += m_LocSched->bytes();
+
+    if (m_RcvSched)
+	cnt += m_RcvSched->bytes();
+
+    for (std::map<int,PersistentComm*>::const_iterator it = m_pers.begin(), End = m_pers.end(); it != End; ++it)
+        cnt += it->second->bytes();
+
     return cnt;
 }
 
+void
+FabArrayBase::BuildMsgTags (const MapOfCopyComTagContainers& m_Tags,
+                            std::vector<MsgTag>&             msgtags)
+{
+    msgtags.clear();
+
+    int msg = 0;
+
+    for (MapOfCopyComTagContainers::const_iterator m_it = m_Tags.begin(), m_End = m_Tags.end();
+         m_it != m_End;
+         ++m_it, ++msg)
+    {
+        int offset = 0;
+
+        for (CopyComTagsContainer::const_iterator it = m_it->second.begin(), End = m_it->second.end();
+             it != End;
+             ++it)
+        {
+            msgtags.push_back(MsgTag(&(*it), msg, offset));
+            offset += it->box.numPts();
+        }
+    }
+}
+
+void
+FabArrayBase::TagSchedule::define (const std::vector< std::pair<int,Box> >& dst,
+                                   bool                                     threadsafe,
+                                   bool                                     color)
+{
+    const int N = dst.size();
+
+    m_parallel = threadsafe || color;
+
+    std::vector<int> tagcolor(N,0);
+
+    int ncolors = (N > 0) ? 1 : 0;
+
+    if (!threadsafe && color)
+    {
+        //
+        // A tag gets the lowest color above those of the earlier tags it overlaps.
+        //
+        std::map< int,std::vector<int> > byfab;
+
+        for (int j = 0; j < N; ++j)
+        {
+            std::vector<int>& prev = byfab[dst[j].first];
+
+            for (int k = 0, M = prev.size(); k < M; ++k)
+            {
+                const int i = prev[k];
+                if (tagcolor[i] >= tagcolor[j] && dst[i].second.intersects(dst[j].second))
+                    tagcolor[j] = tagcolor[i] + 1;
+            }
+
+            prev.push_back(j);
+
+            ncolors = std::max(ncolors, tagcolor[j]+1);
+        }
+    }
+    //
+    // Sort the tags by color, keeping the order within each color.
+    //
+    m_off.resize(ncolors+1);
+    m_idx.resize(N);
+
+    for (int c = 0; c <= ncolors; ++c)
+        m_off[c] = 0;
+    for (int j = 0; j < N; ++j)
+        ++m_off[tagcolor[j]+1];
+    for (int c = 0; c < ncolors; ++c)
+        m_off[c+1] += m_off[c];
+
+    std::vector<int> pos(m_off.begin(), m_off.end());
+
+    for (int j = 0; j < N; ++j)
+        m_idx[pos[tagcolor[j]]++] = j;
+}
+
+long
+FabArrayBase::TagSchedule::bytes () const
+{
+    return sizeof(FabArrayBase::TagSchedule)
+        + (BoxLib::bytesOf(m_off) - sizeof(m_off))
+        + (BoxLib::bytesOf(m_idx) - sizeof(m_idx));
+}
+
 long
 FabArrayBase::bytesOfFBCache ()
 {
@@ -280,6 +535,7 @@ FabArrayBase::CPC::CPC (const BoxArray&            dstba,
     m_dstng(dstng),
     m_srcng(srcng),
     m_nuse(0),
+    m_bytes(0),
     m_threadsafe_loc(false),
     m_threadsafe_rcv(false),
     m_LocTags(0),
@@ -313,18 +569,14 @@ FabArrayBase::TheCPC (const CPC&          cpc,
 
     BL_ASSERT(cpc.m_dstba.size() > 0 && cpc.m_srcba.size() > 0);
     //
-    // We want to choose our keys wisely to minimize search time.
-    // We'd like to distinguish between copies of the same length
-    // but with different edgeness of boxes.  We also want to
-    // differentiate dst.copy(src) from src.copy(dst).
+    // The key differentiates dst.copy(src) from src.copy(dst).
     //
-    CPCCache&      TheCopyCache = FabArrayBase::m_TheCopyCache;
-    const IntVect& Typ          = cpc.m_dstba[0].type();
-    const int      Scale        = D_TERM(Typ[0],+3*Typ[1],+5*Typ[2]) + 11;
+    CPCCache& TheCopyCache = FabArrayBase::m_TheCopyCache;
 
-    int Key = cpc.m_dstba.size() + cpc.m_srcba.size() + Scale;
-    Key    += cpc.m_dstba[0].numPts() + cpc.m_dstba[cpc.m_dstba.size()-1].numPts();
-    Key    += cpc.m_dstdm[0] + cpc.m_dstdm[cpc.m_dstdm.size()-1];
+    unsigned long Key = dst.getBDHash();
+    BoxLib::HashCombine(Key, src.getBDHash());
+    BoxLib::HashCombine(Key, cpc.m_dstng);
+    BoxLib::HashCombine(Key, cpc.m_srcng);
 
     std::pair<CPCCacheIter,CPCCacheIter> er_it = TheCopyCache.equal_range(Key);
 
@@ -333,47 +585,12 @@ FabArrayBase::TheCPC (const CPC&          cpc,
         if (it->second == cpc)
         {
 	    ++it->second.m_nuse;
+            TouchCacheEntry(cpc_lru, it->second);
 	    m_CPC_stats.recordUse();
             return it;
         }
     }
 
-    if (TheCopyCache.size() >= copy_cache_max_size)
-    {
-        //
-        // Don't let the size of the cache get too big.
-        // Get rid of entries with the biggest largest key that haven't been reused.
-        // Otherwise just remove the entry with the largest key.
-        //
-        CPCCache::iterator End      = TheCopyCache.end();
-        CPCCache::iterator last_it  = End;
-        CPCCache::iterator erase_it = End;
-
-        for (CPCCache::iterator it = TheCopyCache.begin(); it != End; ++it)
-        {
-            last_it = it;
-
-            if (it->second.m_nuse <= 1)
-                erase_it = it;
-        }
-
-        if (erase_it != End)
-        {
-#ifdef BL_MEM_PROFILING
-	    m_CPC_stats.bytes -= erase_it->second.bytes();
-#endif
-	    m_CPC_stats.recordErase(erase_it->second.m_nuse);
-            TheCopyCache.erase(erase_it);
-        }
-        else if (last_it != End)
-        {
-#ifdef BL_MEM_PROFILING
-	    m_CPC_stats.bytes -= last_it->second.bytes();
-#endif
-	    m_CPC_stats.recordErase(last_it->second.m_nuse);
-            TheCopyCache.erase(last_it);
-        }
-    }
     //
     // Got to insert one & then build it.
     //
@@ -401,10 +618,7 @@ FabArrayBase::TheCPC (const CPC&          cpc,
         //
         // We don't own any of the relevant FABs so can't possibly have any work to do.
         //
-#ifdef BL_MEM_PROFILING
-	m_CPC_stats.bytes += TheCPC.bytes();
-	m_CPC_stats.bytes_hwm = std::max(m_CPC_stats.bytes_hwm, m_CPC_stats.bytes);
-#endif
+        AddToCache(TheCopyCache, cpc_lru, cache_it, m_CPC_stats, copy_cache_max_size, copy_cache_max_bytes);
         return cache_it;
     }
 
@@ -559,10 +773,7 @@ FabArrayBase::TheCPC (const CPC&          cpc,
 	}
     }    
 
-#ifdef BL_MEM_PROFILING
-    m_CPC_stats.bytes += TheCPC.bytes();
-    m_CPC_stats.bytes_hwm = std::max(m_CPC_stats.bytes_hwm, m_CPC_stats.bytes);
-#endif
+    AddToCache(TheCopyCache, cpc_lru, cache_it, m_CPC_stats, copy_cache_max_size, copy_cache_max_bytes);
 
     return cache_it;
 }
@@ -607,41 +818,58 @@ FabArrayBase::CPC::FlushCache ()
     }
 
     m_TheCopyCache.clear();
-#ifdef BL_MEM_PROFILING
+    cpc_lru.clear();
     m_CPC_stats.bytes = 0L;
-#endif
 }
 
 FabArrayBase::SI::SI ()
     :
     m_ngrow(-1),
     m_nuse(0),
+    m_bytes(0),
     m_cross(false),
+    m_period(IntVect::TheZeroVector()),
+    m_corners(false),
     m_threadsafe_loc(false),
     m_threadsafe_rcv(false),
     m_LocTags(0),
     m_SndTags(0),
     m_RcvTags(0),
     m_SndVols(0),
-    m_RcvVols(0) {}
+    m_RcvVols(0),
+    m_SndMsgTags(0),
+    m_RcvMsgTags(0),
+    m_LocSched(0),
+    m_RcvSched(0) {}
 
 FabArrayBase::SI::SI (const BoxArray&            ba,
                       const DistributionMapping& dm,
                       int                        ngrow,
-                      bool                       cross)
+                      bool                       cross,
+                      const Box&                 pdomain,
+                      const IntVect&             period,
+                      bool                       corners)
     :
     m_ba(ba),
     m_dm(dm),
     m_ngrow(ngrow),
     m_nuse(0),
+    m_bytes(0),
     m_cross(cross),
+    m_pdomain(pdomain),
+    m_period(period),
+    m_corners(corners),
     m_threadsafe_loc(false),
     m_threadsafe_rcv(false),
     m_LocTags(0),
     m_SndTags(0),
     m_RcvTags(0),
     m_SndVols(0),
-    m_RcvVols(0)
+    m_RcvVols(0),
+    m_SndMsgTags(0),
+    m_RcvMsgTags(0),
+    m_LocSched(0),
+    m_RcvSched(0)
 {
     BL_ASSERT(ngrow >= 0);
 }
@@ -653,28 +881,244 @@ FabArrayBase::SI::~SI ()
     delete m_RcvTags;
     delete m_SndVols;
     delete m_RcvVols;
+    delete m_SndMsgTags;
+    delete m_RcvMsgTags;
+    delete m_LocSched;
+    delete m_RcvSched;
+
+    for (std::map<int,PersistentComm*>::iterator it = m_pers.begin(), End = m_pers.end(); it != End; ++it)
+        delete it->second;
+}
+
+FabArrayBase::PersistentComm::PersistentComm ()
+    :
+    m_nbytes(0),
+    m_tag(-1),
+    m_busy(false),
+    m_buf_bytes(0),
+    m_the_recv_data(0),
+    m_the_send_data(0) {}
+
+FabArrayBase::PersistentComm::~PersistentComm ()
+{
+    clear();
+}
+
+void
+FabArrayBase::PersistentComm::clear ()
+{
+    if (m_busy)
+    {
+        //
+        // Never free requests that are still active.  Every process started
+        // them, so completing them here can't hang.
+        //
+        waitRecvs();
+        waitSends();
+
+        m_busy = false;
+    }
+
+#ifdef BL_USE_MPI
+    for (int i = 0; i < m_recv_reqs.size(); ++i)
+        BL_MPI_REQUIRE( MPI_Request_free(&m_recv_reqs[i]) );
+    for (int i = 0; i < m_send_reqs.size(); ++i)
+        BL_MPI_REQUIRE( MPI_Request_free(&m_send_reqs[i]) );
+#endif
+
+    if (m_the_recv_data) BoxLib::The_Arena()->free(m_the_recv_data);
+    if (m_the_send_data) BoxLib::The_Arena()->free(m_the_send_data);
+
+    m_nbytes        = 0;
+    m_tag           = -1;
+    m_buf_bytes     = 0;
+    m_the_recv_data = 0;
+    m_the_send_data = 0;
+
+    m_recv_from.clear();
+    m_recv_data.clear();
+    m_recv_reqs.clear();
+    m_send_to.clear();
+    m_send_data.clear();
+    m_send_reqs.clear();
+}
+
+void
+FabArrayBase::PersistentComm::define (const std::map<int,int>& RcvVols,
+                                      const std::map<int,int>& SndVols,
+                                      int                      nbytes,
+                                      int                      tag)
+{
+    BL_PROFILE("FabArray::PersistentComm::define()");
+
+    BL_ASSERT(nbytes > 0);
+
+    clear();
+
+    m_nbytes = nbytes;
+    m_tag    = tag;
+
+#ifdef BL_USE_MPI
+    const MPI_Comm comm = ParallelDescriptor::Communicator();
+
+    for (int ipass = 0; ipass < 2; ++ipass) // pass 0: recvs, pass 1: sends
+    {
+        const std::map<int,int>& Vols = (ipass == 0) ? RcvVols         : SndVols;
+        char*&                   the  = (ipass == 0) ? m_the_recv_data : m_the_send_data;
+        Array<int>&              pids = (ipass == 0) ? m_recv_from     : m_send_to;
+        Array<char*>&            data = (ipass == 0) ? m_recv_data     : m_send_data;
+        Array<MPI_Request>&      reqs = (ipass == 0) ? m_recv_reqs     : m_send_reqs;
+
+        long TotalVolume = 0;
+
+        for (std::map<int,int>::const_iterator it = Vols.begin(), End = Vols.end(); it != End; ++it)
+            TotalVolume += it->second;
+
+        if (TotalVolume == 0) continue;
+
+        BL_ASSERT(TotalVolume*nbytes < std::numeric_limits<int>::max());
+
+        the = static_cast<char*>(BoxLib::The_Arena()->alloc(TotalVolume*nbytes));
+
+        m_buf_bytes += TotalVolume*nbytes;
+
+        pids.reserve(Vols.size());
+        data.reserve(Vols.size());
+        reqs.reserve(Vols.size());
+
+        long Offset = 0;
+
+        for (std::map<int,int>::const_iterator it = Vols.begin(), End = Vols.end(); it != End; ++it)
+        {
+            const int N = it->second*nbytes;
+
+            MPI_Request req;
+
+            if (ipass == 0) {
+                BL_MPI_REQUIRE( MPI_Recv_init(the+Offset, N, MPI_CHAR, it->first,
+                                              m_tag, comm, &req) );
+            } else {
+                BL_MPI_REQUIRE( MPI_Send_init(the+Offset, N, MPI_CHAR, it->first,
+                                              m_tag, comm, &req) );
+            }
+
+            pids.push_back(it->first);
+            data.push_back(the+Offset);
+            reqs.push_back(req);
+
+            Offset += N;
+        }
+    }
+#endif /*BL_USE_MPI*/
+}
+
+void
+FabArrayBase::PersistentComm::startRecvs ()
+{
+#ifdef BL_USE_MPI
+    if (!m_recv_reqs.empty())
+        BL_MPI_REQUIRE( MPI_Startall(m_recv_reqs.size(), m_recv_reqs.dataPtr()) );
+#endif
+}
+
+void
+FabArrayBase::PersistentComm::startSends ()
+{
+#ifdef BL_USE_MPI
+    if (!m_send_reqs.empty())
+        BL_MPI_REQUIRE( MPI_Startall(m_send_reqs.size(), m_send_reqs.dataPtr()) );
+#endif
+}
+
+void
+FabArrayBase::PersistentComm::waitRecvs ()
+{
+#ifdef BL_USE_MPI
+    if (!m_recv_reqs.empty())
+        BL_MPI_REQUIRE( MPI_Waitall(m_recv_reqs.size(), m_recv_reqs.dataPtr(), MPI_STATUSES_IGNORE) );
+#endif
+}
+
+void
+FabArrayBase::PersistentComm::waitSends ()
+{
+#ifdef BL_USE_MPI
+    if (!m_send_reqs.empty())
+        BL_MPI_REQUIRE( MPI_Waitall(m_send_reqs.size(), m_send_reqs.dataPtr(), MPI_STATUSES_IGNORE) );
+#endif
+}
+
+long
+FabArrayBase::PersistentComm::bytes () const
+{
+    return sizeof(PersistentComm) + m_buf_bytes
+        + (m_recv_from.size() + m_send_to.size())*(sizeof(int) + sizeof(char*) + sizeof(MPI_Request));
 }
 
 bool
 FabArrayBase::SI::operator== (const SI& rhs) const
 {
     return
-        m_ngrow == rhs.m_ngrow && m_cross == rhs.m_cross && m_ba == rhs.m_ba && m_dm == rhs.m_dm;
+        m_ngrow   == rhs.m_ngrow   && m_cross   == rhs.m_cross   &&
+        m_pdomain == rhs.m_pdomain && m_period  == rhs.m_period  &&
+        m_corners == rhs.m_corners &&
+        m_ba      == rhs.m_ba      && m_dm      == rhs.m_dm;
+}
+
+Box
+FabArrayBase::PeriodicDomain (const Geometry& geom)
+{
+    return geom.isAnyPeriodic() ? geom.Domain() : Box();
+}
+
+IntVect
+FabArrayBase::Period (const Geometry& geom)
+{
+    IntVect period(IntVect::TheZeroVector());
+
+    for (int dir = 0; dir < BL_SPACEDIM; ++dir)
+        if (geom.isPeriodic(dir))
+            period[dir] = geom.period(dir);
+
+    return period;
 }
 
 FabArrayBase::FBCacheIter
 FabArrayBase::TheFB (bool                cross,
-                     const FabArrayBase& mf)
+                     const FabArrayBase& mf,
+                     int                 ngrow,
+                     const Box&          pdomain,
+                     const IntVect&      period,
+                     bool                corners)
 {
     BL_PROFILE("FabArray::TheFB");
 
     BL_ASSERT(mf.size() > 0);
+    BL_ASSERT(ngrow <= mf.nGrow());
+    BL_ASSERT(pdomain.isEmpty() || pdomain.cellCentered());
+    BL_ASSERT(pdomain.isEmpty() == (period == IntVect::TheZeroVector()));
 
-    const FabArrayBase::SI si(mf.boxArray(), mf.DistributionMap(), mf.nGrow(), cross);
+    if (ngrow < 0) ngrow = mf.nGrow();
+    //
+    // Corners only matter for periodic images.
+    //
+    if (pdomain.isEmpty()) corners = false;
 
-    const IntVect& Typ   = mf.boxArray()[0].type();
-    const int      Scale = D_TERM(Typ[0],+3*Typ[1],+5*Typ[2]) + 11;
-    const int      Key   = mf.size() + mf.boxArray()[0].numPts() + mf.nGrow() + Scale + cross;
+    const FabArrayBase::SI si(mf.boxArray(), mf.DistributionMap(), ngrow, cross, pdomain, period, corners);
+
+    unsigned long Key = mf.getBDHash();
+    BoxLib::HashCombine(Key, ngrow);
+    BoxLib::HashCombine(Key, cross);
+    if (!pdomain.isEmpty())
+    {
+        for (int dir = 0; dir < BL_SPACEDIM; ++dir)
+        {
+            BoxLib::HashCombine(Key, pdomain.smallEnd(dir));
+            BoxLib::HashCombine(Key, pdomain.bigEnd(dir));
+            BoxLib::HashCombine(Key, period[dir]);
+        }
+        BoxLib::HashCombine(Key, corners);
+    }
 
     std::pair<FBCacheIter,FBCacheIter> er_it = m_TheFBCache.equal_range(Key);
 
@@ -683,47 +1127,12 @@ FabArrayBase::TheFB (bool                cross,
         if (it->second == si)
         {
 	    ++it->second.m_nuse;
+            TouchCacheEntry(fb_lru, it->second);
 	    m_FBC_stats.recordUse();
             return it;
         }
     }
 
-    if (m_TheFBCache.size() >= fb_cache_max_size)
-    {
-        //
-        // Don't let the size of the cache get too big.
-        // Get rid of entries with the biggest largest key that haven't been reused.
-        // Otherwise just remove the entry with the largest key.
-        //
-        FBCacheIter End      = m_TheFBCache.end();
-        FBCacheIter last_it  = End;
-        FBCacheIter erase_it = End;
-
-        for (FBCacheIter it = m_TheFBCache.begin(); it != End; ++it)
-        {
-            last_it = it;
-
-            if (it->second.m_nuse <= 1)
-                erase_it = it;
-        }
-
-        if (erase_it != End)
-        {
-#ifdef BL_MEM_PROFILING
-	    m_FBC_stats.bytes -= erase_it->second.bytes();
-#endif
-	    m_FBC_stats.recordErase(erase_it->second.m_nuse);
-            m_TheFBCache.erase(erase_it);
-        }
-        else if (last_it != End)
-        {
-#ifdef BL_MEM_PROFILING
-	    m_FBC_stats.bytes -= last_it->second.bytes();
-#endif
-	    m_FBC_stats.recordErase(last_it->second.m_nuse);
-	    m_TheFBCache.erase(last_it);
-        }
-    }
     //
     // Got to insert one & then build it.
     //
@@ -745,6 +1154,11 @@ FabArrayBase::TheFB (bool                cross,
     TheFB.m_SndVols = new std::map<int,int>;
     TheFB.m_RcvVols = new std::map<int,int>;
 
+    TheFB.m_SndMsgTags = new std::vector<MsgTag>;
+    TheFB.m_RcvMsgTags = new std::vector<MsgTag>;
+    TheFB.m_LocSched   = new TagSchedule;
+    TheFB.m_RcvSched   = new TagSchedule;
+
     TheFB.m_nuse = 1;
 
     m_FBC_stats.recordBuild();
@@ -754,10 +1168,7 @@ FabArrayBase::TheFB (bool                cross,
         //
         // We don't own any of the relevant FABs so can't possibly have any work to do.
         //
-#ifdef BL_MEM_PROFILING
-	m_FBC_stats.bytes += TheFB.bytes();
-	m_FBC_stats.bytes_hwm = std::max(m_FBC_stats.bytes_hwm, m_FBC_stats.bytes);
-#endif
+        AddToCache(m_TheFBCache, fb_lru, cache_it, m_FBC_stats, fb_cache_max_size, fb_cache_max_bytes);
         return cache_it;
     }
 
@@ -767,6 +1178,17 @@ FabArrayBase::TheFB (bool                cross,
     const int nlocal = imap.size();
     const int ng = si.m_ngrow;
     std::vector< std::pair<int,Box> > isects;
+    //
+    // With a periodic domain, the images of the boxes shifted by the
+    // periods are neighbors too.  The shift of the box itself comes first.
+    //
+    const bool periodic = !pdomain.isEmpty();
+
+    Box TheDomain = pdomain;
+    TheDomain.convert(ba.ixType());
+    const Box& GrownDomain = BoxLib::grow(TheDomain,ng);
+
+    std::vector<IntVect> shifts;
 
     CopyComTag::MapOfCopyComTagContainers send_tags; // temp copy
 
@@ -775,22 +1197,33 @@ FabArrayBase::TheFB (bool                cross,
 	const int ksnd = imap[i];
 	const Box& vbx = ba[ksnd];
 
-	ba.intersections(vbx, isects, ng);
+	shifts.clear();
+	if (periodic && !TheDomain.contains(BoxLib::grow(vbx,ng)))
+	    PeriodicShifts(GrownDomain, vbx, period, shifts);
+	shifts.insert(shifts.begin(), IntVect::TheZeroVector());
 
-	for (int j = 0, M = isects.size(); j < M; ++j)
+	for (int s = 0, NS = shifts.size(); s < NS; ++s)
 	{
-	    const int krcv      = isects[j].first;
-	    const Box& bx       = isects[j].second;
-	    const int dst_owner = dm[krcv];
+	    const IntVect& sh = shifts[s];
 
-	    if (krcv == ksnd) continue;  // same box
+	    ba.intersections(vbx+sh, isects, ng);
 
-	    if (ParallelDescriptor::sameTeam(dst_owner)) {
-		continue;  // local copy will be dealt with later
-	    } else if (MyProc == dm[ksnd]) {
-		const BoxList& bl = BoxLib::boxDiff(bx, ba[krcv]);
-		for (BoxList::const_iterator lit = bl.begin(); lit != bl.end(); ++lit)
-		    send_tags[dst_owner].push_back(CopyComTag(*lit, krcv, ksnd));
+	    for (int j = 0, M = isects.size(); j < M; ++j)
+	    {
+		const int krcv      = isects[j].first;
+		Box       bx        = isects[j].second;
+		const int dst_owner = dm[krcv];
+
+		if (krcv == ksnd && s == 0) continue;  // same box
+
+		if (ParallelDescriptor::sameTeam(dst_owner)) {
+		    continue;  // local copy will be dealt with later
+		} else if (MyProc == dm[ksnd]) {
+		    if (s > 0 && corners) GrowCorners(bx, ba[krcv], TheDomain, period, ng);
+		    const BoxList& bl = BoxLib::boxDiff(bx, ba[krcv]);
+		    for (BoxList::const_iterator lit = bl.begin(); lit != bl.end(); ++lit)
+			send_tags[dst_owner].push_back(CopyComTag(*lit, krcv, ksnd, sh));
+		}
 	    }
 	}
     }
@@ -816,6 +1249,10 @@ FabArrayBase::TheFB (bool                cross,
         check_local = false;
         check_remote = false;
     }
+    //
+    // Whatever turns out not to be thread safe gets colored.
+    //
+    const bool color_local = check_local, color_remote = check_remote;
 
     for (int i = 0; i < nlocal; ++i)
     {
@@ -833,36 +1270,51 @@ FabArrayBase::TheFB (bool                cross,
 	    remotetouch.setVal(0);
 	}
 
-	ba.intersections(bxrcv, isects);
+	//
+	// Here the shifts take the ghost cells to the images' sources.
+	//
+	shifts.clear();
+	if (periodic && !TheDomain.contains(bxrcv))
+	    PeriodicShifts(TheDomain, bxrcv, period, shifts);
+	shifts.insert(shifts.begin(), IntVect::TheZeroVector());
 
-	for (int j = 0, M = isects.size(); j < M; ++j)
+	for (int s = 0, NS = shifts.size(); s < NS; ++s)
 	{
-	    const int ksnd      = isects[j].first;
-	    const Box& bx       = isects[j].second;
-	    const int src_owner = dm[ksnd];
+	    const IntVect& sh = shifts[s];
 
-	    if (krcv == ksnd) continue;  // same box
+	    ba.intersections(bxrcv+sh, isects);
 
-	    const BoxList& bl = BoxLib::boxDiff(bx, vbx);
-	    for (BoxList::const_iterator lit = bl.begin(); lit != bl.end(); ++lit)
+	    for (int j = 0, M = isects.size(); j < M; ++j)
 	    {
-		const Box& blbx = *lit;
+		const int ksnd      = isects[j].first;
+		Box       bx        = isects[j].second;
+		const int src_owner = dm[ksnd];
 
-		if (ParallelDescriptor::sameTeam(src_owner)) { // local copy
-		    const BoxList tilelist(blbx, FabArrayBase::comm_tile_size);
-		    for (BoxList::const_iterator
-			     it_tile  = tilelist.begin(),
-			     End_tile = tilelist.end();   it_tile != End_tile; ++it_tile)
-		    {
-			TheFB.m_LocTags->push_back(CopyComTag(*it_tile, krcv, ksnd));
-		    }
-		    if (check_local) {
-			localtouch.plus(1, blbx);
-		    }
-		} else if (MyProc == dm[krcv]) {
-		    recv_tags[src_owner].push_back(CopyComTag(blbx, krcv, ksnd));
-		    if (check_remote) {
-			remotetouch.plus(1, blbx);
+		if (krcv == ksnd && s == 0) continue;  // same box
+
+		if (s > 0 && corners) GrowCorners(bx, vbx, TheDomain, period, ng);
+
+		const BoxList& bl = BoxLib::boxDiff(bx-sh, vbx);
+		for (BoxList::const_iterator lit = bl.begin(); lit != bl.end(); ++lit)
+		{
+		    const Box& blbx = *lit;
+
+		    if (ParallelDescriptor::sameTeam(src_owner)) { // local copy
+			const BoxList tilelist(blbx, FabArrayBase::comm_tile_size);
+			for (BoxList::const_iterator
+				 it_tile  = tilelist.begin(),
+				 End_tile = tilelist.end();   it_tile != End_tile; ++it_tile)
+			{
+			    TheFB.m_LocTags->push_back(CopyComTag(*it_tile, krcv, ksnd, -sh));
+			}
+			if (check_local) {
+			    localtouch.plus(1, blbx);
+			}
+		    } else if (MyProc == dm[krcv]) {
+			recv_tags[src_owner].push_back(CopyComTag(blbx, krcv, ksnd, -sh));
+			if (check_remote) {
+			    remotetouch.plus(1, blbx);
+			}
 		    }
 		}
 	    }
@@ -912,7 +1364,13 @@ FabArrayBase::TheFB (bool                cross,
 		std::vector<Box> boxes;
 		int vol = 0;
 
-		if (si.m_cross) {
+		//
+		// The cross stencil only cuts down what comes from the
+		// non-periodic neighbors.  Like FillPeriodicBoundary(), we
+		// fill all of the ghost cells covered by periodic images,
+		// corners included.
+		//
+		if (si.m_cross && it2->shift == IntVect::TheZeroVector()) {
 		    const Box& dstfabbx = ba[it2->fabIndex];
 		    for (int dir = 0; dir < BL_SPACEDIM; dir++)
 	            {
@@ -952,7 +1410,7 @@ FabArrayBase::TheFB (bool                cross,
 				 it_tile  = tilelist.begin(), 
 				 End_tile = tilelist.end();   it_tile != End_tile; ++it_tile)
 			{
-			    new_cctv.push_back(CopyComTag(*it_tile, it2->fabIndex, it2->srcIndex));
+			    new_cctv.push_back(CopyComTag(*it_tile, it2->fabIndex, it2->srcIndex, it2->shift));
 			}
 		    }
 		}
@@ -963,10 +1421,25 @@ FabArrayBase::TheFB (bool                cross,
 	}
     }
 
-#ifdef BL_MEM_PROFILING
-	m_FBC_stats.bytes += TheFB.bytes();
-	m_FBC_stats.bytes_hwm = std::max(m_FBC_stats.bytes_hwm, m_FBC_stats.bytes);
-#endif
+    BuildMsgTags(*TheFB.m_SndTags, *TheFB.m_SndMsgTags);
+    BuildMsgTags(*TheFB.m_RcvTags, *TheFB.m_RcvMsgTags);
+
+    std::vector< std::pair<int,Box> > dst;
+
+    dst.reserve(TheFB.m_LocTags->size());
+    for (int i = 0, N = TheFB.m_LocTags->size(); i < N; ++i)
+        dst.push_back(std::make_pair((*TheFB.m_LocTags)[i].fabIndex, (*TheFB.m_LocTags)[i].box));
+
+    TheFB.m_LocSched->define(dst, TheFB.m_threadsafe_loc, color_local);
+
+    dst.clear();
+    dst.reserve(TheFB.m_RcvMsgTags->size());
+    for (int i = 0, N = TheFB.m_RcvMsgTags->size(); i < N; ++i)
+        dst.push_back(std::make_pair((*TheFB.m_RcvMsgTags)[i].tag->fabIndex, (*TheFB.m_RcvMsgTags)[i].tag->box));
+
+    TheFB.m_RcvSched->define(dst, TheFB.m_threadsafe_rcv, color_remote);
+
+    AddToCache(m_TheFBCache, fb_lru, cache_it, m_FBC_stats, fb_cache_max_size, fb_cache_max_bytes);
 
     return cache_it;
 }
@@ -981,6 +1454,7 @@ FabArrayBase::FPC::FPC (const FabArrayBase& srcfa,
       m_dstdomain(dstdomain),
       m_dstng    (dstng),
       m_coarsener(coarsener.clone()),
+      m_crse_patch_bytes(0),
       m_nuse     (0)
 { 
     BL_PROFILE("FPC::FPC()");
@@ -1031,6 +1505,21 @@ FabArrayBase::FPC::FPC (const FabArrayBase& srcfa,
 FabArrayBase::FPC::~FPC ()
 {
     delete m_coarsener;
+    clearCrsePatch();
+}
+
+void
+FabArrayBase::FPC::TrimCrsePatches (const FPC* keep)
+{
+    if (fpc_cache_max_bytes <= 0) return;
+
+    for (FPCCacheIter it = m_TheFillPatchCache.begin(), End = m_TheFillPatchCache.end();
+         it != End && m_FPC_stats.bytes > fpc_cache_max_bytes;
+         ++it)
+    {
+        if (it->second != keep)
+            it->second->clearCrsePatch();
+    }
 }
 
 long
@@ -1062,7 +1551,7 @@ FabArrayBase::TheFPC (const FabArrayBase& srcfa,
 	    it->second->m_dstdomain == dstdomain &&
 	    it->second->m_dstng     == dstng     &&
 	    it->second->m_dstdomain.ixType() == dstdomain.ixType() &&
-	    it->second->m_coarsener->doit(it->second->m_dstdomain) == coarsener.doit(dstdomain))
+	    *(it->second->m_coarsener) == coarsener)
 	{
 	    ++it->second->m_nuse;
 	    m_FPC_stats.recordUse();
@@ -1073,10 +1562,8 @@ FabArrayBase::TheFPC (const FabArrayBase& srcfa,
     // Have to build a new one
     FPC* new_fpc = new FPC(srcfa, dstfa, dstdomain, dstng, coarsener);
 
-#ifdef BL_MEM_PROFILING
     m_FPC_stats.bytes += new_fpc->bytes();
     m_FPC_stats.bytes_hwm = std::max(m_FPC_stats.bytes_hwm, m_FPC_stats.bytes);
-#endif
     
     new_fpc->m_nuse = 1;
     m_FPC_stats.recordBuild();
@@ -1117,9 +1604,7 @@ FabArrayBase::flushFPC ()
 	    }
 	} 
 
-#ifdef BL_MEM_PROFILING
 	m_FPC_stats.bytes -= it->second->bytes();
-#endif
 	m_FPC_stats.recordErase(it->second->m_nuse);
 	delete it->second;
     }
@@ -1192,9 +1677,8 @@ FabArrayBase::FlushSICache ()
     }
 
     m_TheFBCache.clear();
-#ifdef BL_MEM_PROFILING
+    fb_lru.clear();
     m_FBC_stats.bytes = 0L;
-#endif
 }
 
 int
@@ -1417,6 +1901,16 @@ FabArrayBase::addThisBD ()
     }
 }
 
+unsigned long
+FabArrayBase::getBDHash () const
+{
+    unsigned long h = boxarray.contentHash();
+
+    BoxLib::HashCombine(h, distributionMap.contentHash());
+
+    return h;
+}
+
 void
 FabArrayBase::updateBDKey ()
 {
@@ -1565,7 +2059,8 @@ MFIter::tilebox () const
     if (! typ.cellCentered())
     {
 	bx.convert(typ);
-	const IntVect& Big = validbox().bigEnd();
+	const Box&     vbx = validbox();
+	const IntVect& Big = vbx.bigEnd();
 	for (int d=0; d<BL_SPACEDIM; ++d) {
 	    if (typ.nodeCentered(d)) { // validbox should also be nodal in d-direction.
 		if (bx.bigEnd(d) < Big[d]) {
@@ -1583,7 +2078,8 @@ MFIter::nodaltilebox (int dir) const
     BL_ASSERT(tile_array != 0);
     Box bx((*tile_array)[currentIndex]);
     bx.convert(typ);
-    const IntVect& Big = validbox().bigEnd();
+    const Box&     vbx = validbox();
+    const IntVect& Big = vbx.bigEnd();
     int d0, d1;
     if (dir < 0) {
 	d0 = 0;
@@ -1619,6 +2115,17 @@ MFIter::growntilebox (int ng) const
     return bx;
 }
 
+Box
+MFIter::growntilebox (int ng, int width, int stage) const
+{
+    const int nleft = ng - (stage+1)*width;
+
+    BL_ASSERT(width > 0 && stage >= 0);
+    BL_ASSERT(nleft >= 0);
+
+    return growntilebox(nleft);
+}
+
 Box
 MFIter::grownnodaltilebox (int dir, int ng) const
 {
@@ -1733,3 +2240,92 @@ MFGhostIter::Initialize ()
     local_index_map = &(lta.localIndexMap);
     tile_array      = &(lta.tileArray);
 }
+
+MFOverlapIter::MFOverlapIter (const FabArrayBase& fabarray,
+                              int                 nghost,
+                              Region              region,
+                              bool                do_tiling)
+    :
+    MFIter(fabarray, (unsigned char)(do_tiling ? (SkipInit|Tiling) : SkipInit))
+{
+    Initialize(nghost, region);
+}
+
+void
+MFOverlapIter::Initialize (int nghost, Region region)
+{
+    BL_ASSERT(nghost >= 0);
+
+    const FabArrayBase::TileArray* pta = fabArray.getTileArray(tile_size);
+
+    int rit = 0;
+    int nworkers = 1;
+#ifdef BL_USE_TEAM
+    if (ParallelDescriptor::TeamSize() > 1 && tile_size != IntVect::TheZeroVector()) {
+	rit = ParallelDescriptor::MyRankInTeam();
+	nworkers = ParallelDescriptor::TeamSize();
+    }
+#endif
+
+    int tid = 0;
+    int nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_num_threads();
+    if (nthreads > 1)
+	tid = omp_get_thread_num();
+#endif
+
+    const int npes = nworkers*nthreads;
+    const int pid  = rit*nthreads+tid;
+    //
+    // Split the tiles, which are always cell-centered, and hand out the
+    // pieces round-robin.  The splitting does not depend on the thread,
+    // so every piece goes to exactly one thread.
+    //
+    int ipiece = 0;
+
+    for (int i = 0, N = pta->tileArray.size(); i < N; ++i)
+    {
+	const int  K    = pta->indexMap[i];
+	const Box& tbx  = pta->tileArray[i];
+	const Box& ibx  = BoxLib::grow(fabArray.boxArray().getCellCenteredBox(K), -nghost);
+	const Box& isec = tbx & ibx;
+
+	if (region == InteriorRegion)
+	{
+	    if (isec.ok())
+	    {
+		if (ipiece++ % npes == pid)
+		{
+		    lta.indexMap.push_back(K);
+		    lta.localIndexMap.push_back(pta->localIndexMap[i]);
+		    lta.tileArray.push_back(isec);
+		}
+	    }
+	}
+	else
+	{
+	    const BoxList& diff = isec.ok() ? BoxLib::boxDiff(tbx, isec) : BoxList(tbx);
+
+	    for (BoxList::const_iterator bli = diff.begin(); bli != diff.end(); ++bli)
+	    {
+		if (ipiece++ % npes == pid)
+		{
+		    lta.indexMap.push_back(K);
+		    lta.localIndexMap.push_back(pta->localIndexMap[i]);
+		    lta.tileArray.push_back(*bli);
+		}
+	    }
+	}
+    }
+
+    currentIndex = beginIndex = 0;
+    endIndex = lta.indexMap.size();
+
+    lta.nuse = 0;
+    index_map       = &(lta.indexMap);
+    local_index_map = &(lta.localIndexMap);
+    tile_array      = &(lta.tileArray);
+
+    typ = fabArray.boxArray().ixType();
+}
@@ -1,5 +1,6 @@
 cxxsources += MemPool.cpp
 cxxsources += CArena.cpp
+cxxsources += SArena.cpp
 cxxsources += Arena.cpp
 
 f90sources += mempool_f.f90
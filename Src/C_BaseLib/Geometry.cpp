@@ -344,7 +344,7 @@ Geometry::SumPeriodicBoundary (MultiFab& mf,
 	ParallelDescriptor::Color mycolor = mf.color();
 	if (mycolor == ParallelDescriptor::DefaultColor()) {
 	    SeqNum = ParallelDescriptor::SeqNum();
-	} else if (mycolor == ParallelDescriptor::SubCommColor()) {
+	} else if (ParallelDescriptor::isActive(mycolor)) {
 	    SeqNum = ParallelDescriptor::SubSeqNum();
 	}
 	// else I don't have any data and my SubSeqNum() should not be called.
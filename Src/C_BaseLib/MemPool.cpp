@@ -8,8 +8,7 @@
 #include <new>
 #include <cstring>
 
-#include <CArena.H>
-#include <PArray.H>
+#include <SArena.H>
 #include <MemPool.H>
 
 #ifdef BL_MEM_PROFILING
@@ -22,13 +21,23 @@
 
 namespace
 {
-    static PArray<CArena> the_memory_pool;
+    //
+    // One arena for all threads; it keeps a cache per thread so memory
+    // allocated by one thread may be freed by another.
+    //
+    static SArena* the_memory_pool = 0;
 #if defined(BL_TESTING) || defined(DEBUG)
     static int init_snan = 1;
 #else
     static int init_snan = 0;
 #endif
     static bool equal_size_double_longlong = true;
+    //
+    // By default every thread grabs and touches a hunk of the pool (8 MB)
+    // at start-up, so the pages are placed near the thread that uses them.
+    // fab.mempool_prefill = 0 turns this off.
+    //
+    static int prefill = 1;
 }
 
 extern "C" {
@@ -43,27 +52,19 @@ void mempool_init()
 #ifndef FORTRAN_BOXLIB
         ParmParse pp("fab");
 	pp.query("init_snan", init_snan);
+	pp.query("mempool_prefill", prefill);
 #endif
 
         equal_size_double_longlong = sizeof(double) == sizeof(long long);
 
-#ifdef _OPENMP
-	int nthreads = omp_get_max_threads();
-#else
-	int nthreads = 1;
-#endif
-	the_memory_pool.resize(nthreads, PArrayManage);
-	for (int i=0; i<nthreads; ++i) {
-	    the_memory_pool.set(i, new CArena());
-	}
+	the_memory_pool = new SArena();
+
+	if (prefill)
+	{
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
-	{
-	    size_t N = 1024*1024*sizeof(double);
-	    void *p = mempool_alloc(N);
-	    memset(p, 0, N);
-	    mempool_free(p);
+	    the_memory_pool->prefill();
 	}
 
 #ifdef BL_MEM_PROFILING
@@ -73,46 +74,57 @@ void mempool_init()
 		long b = MB_tot * (1024L*1024L);
 		return {b, b};
 	    });
+	//
+	// The pool split into the part handed out and the free part, whose
+	// share of the pool is mempool_get_fragmentation().  Both are already
+	// counted in MemPool.
+	//
+	MemProfiler::add("MemPoolInUse", [] () -> MemProfiler::MemInfo {
+		return {long(the_memory_pool->heap_space_actually_used()),
+			long(the_memory_pool->heap_space_hwm())};
+	    }, false);
+	MemProfiler::add("MemPoolFree", [] () -> MemProfiler::MemInfo {
+		static long hwm = 0;
+		long b = long(the_memory_pool->heap_space_used())
+		       - long(the_memory_pool->heap_space_actually_used());
+		hwm = std::max(hwm, b);
+		return {b, hwm};
+	    }, false);
 #endif
     }
 }
 
 void* mempool_alloc (size_t nbytes)
 {
-#ifdef _OPENMP
-  int tid = omp_get_thread_num();
-#else
-  int tid = 0;
-#endif
-  return the_memory_pool[tid].alloc(nbytes);
+  return the_memory_pool->alloc(nbytes);
 }
 
 void mempool_free (void* p) 
 {
-#ifdef _OPENMP
-  int tid = omp_get_thread_num();
-#else
-  int tid = 0;
-#endif
-  the_memory_pool[tid].free(p);
+  the_memory_pool->free(p);
 }
 
 void mempool_get_stats (int& mp_min, int& mp_max, int& mp_tot) // min, max & tot in MB
 {
   size_t hsu_min=std::numeric_limits<size_t>::max();
   size_t hsu_max=0;
-  size_t hsu_tot=0;
-  for (int i=0; i<the_memory_pool.size(); ++i) {
-    size_t hsu = the_memory_pool[i].heap_space_used();
+  for (int i=0; i<the_memory_pool->nThreads(); ++i) {
+    size_t hsu = the_memory_pool->heap_space_used(i);
     hsu_min = std::min(hsu, hsu_min);
     hsu_max = std::max(hsu, hsu_max);
-    hsu_tot += hsu;
   }
+  // The total includes the big blocks and the shared cache.
+  size_t hsu_tot = the_memory_pool->heap_space_used();
   mp_min = hsu_min/(1024*1024);
   mp_max = hsu_max/(1024*1024);
   mp_tot = hsu_tot/(1024*1024);
 }
 
+double mempool_get_fragmentation ()
+{
+  return the_memory_pool->fragmentation();
+}
+
 void double_array_init (double* p, size_t nelems)
 {
     if (init_snan) array_init_snan(p, nelems);
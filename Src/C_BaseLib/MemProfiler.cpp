@@ -17,7 +17,8 @@
 #include <ParmParse.H>
 
 void 
-MemProfiler::add(const std::string& name, std::function<MemInfo()>&& f)
+MemProfiler::add(const std::string& name, std::function<MemInfo()>&& f,
+		 bool in_total)
 {
     MemProfiler& mprofiler = getInstance();
     auto it = std::find(mprofiler.the_names.begin(), mprofiler.the_names.end(), name);
@@ -27,6 +28,7 @@ MemProfiler::add(const std::string& name, std::function<MemInfo()>&& f)
     }
     mprofiler.the_names.push_back(name);
     mprofiler.the_funcs.push_back(std::forward<std::function<MemInfo()> >(f));
+    mprofiler.the_in_total.push_back(in_total);
 }
 
 MemProfiler& 
@@ -73,7 +75,10 @@ MemProfiler::report_ (const std::string& prefix, const std::string& memory_log_n
     std::vector<long> mymin(N, 0L);
     std::vector<long> mymax(N, 0L);
 
-    mymin[0] = mymax[0] = std::accumulate(cur_min.begin(), cur_min.end(), 0L);
+    for (int i = 0, N = cur_min.size(); i < N; ++i) {
+	if (the_in_total[i]) mymin[0] += cur_min[i];
+    }
+    mymax[0] = mymin[0];
 
 #ifdef __linux
     int ierr_proc_status = 0;
@@ -6,6 +6,8 @@
 #include <iomanip>
 #include <map>
 #include <limits>
+#include <vector>
+#include <cmath>
 
 #include <BLassert.H>
 #include <MultiFab.H>
@@ -1350,6 +1352,35 @@ MultiFab::FillBoundary (bool local, bool cross)
     FillBoundary(0, n_comp, local, cross);
 }
 
+void
+MultiFab::FillBoundary (const Geometry& geom, bool cross, bool corners)
+{
+    FillBoundary(0, n_comp, geom, cross, corners);
+}
+
+void
+MultiFab::FillBoundary (int             scomp,
+                        int             ncomp,
+                        const Geometry& geom,
+                        bool            cross,
+                        bool            corners)
+{
+    if ( n_grow <= 0 ) return;
+
+    FabArray<FArrayBox>::FillBoundary(scomp,ncomp,geom,cross,corners);
+}
+
+void
+MultiFab::FillBoundary (const Array<MultiFab*>& mfs, bool cross)
+{
+    Array<FabArray<FArrayBox>*> fas(mfs.size());
+
+    for (int i = 0; i < mfs.size(); ++i)
+        fas[i] = mfs[i];
+
+    FabArray<FArrayBox>::FillBoundary(fas, cross);
+}
+
 //
 // Some useful typedefs.
 //
@@ -1410,7 +1441,7 @@ MultiFab::SumBoundary (int scomp,
 	ParallelDescriptor::Color mycolor = this->color();
 	if (mycolor == ParallelDescriptor::DefaultColor()) {
 	    SeqNum = ParallelDescriptor::SeqNum();
-	} else if (mycolor == ParallelDescriptor::SubCommColor()) {
+	} else if (ParallelDescriptor::isActive(mycolor)) {
 	    SeqNum = ParallelDescriptor::SubSeqNum();
 	}
 	// else I don't have any data and my SubSeqNum() should not be called.
@@ -1582,6 +1613,51 @@ MultiFab::SumBoundary ()
     SumBoundary(0, n_comp);
 }
 
+MultiFab&
+FabArrayBase::FPC::crsePatch (int ncomp) const
+{
+    BL_ASSERT(!ba_crse_patch.empty());
+
+    std::map<int,MultiFab*>::const_iterator it = m_crse_patch.find(ncomp);
+
+    if (it != m_crse_patch.end())
+        return *(it->second);
+
+    MultiFab* mf = new MultiFab(ba_crse_patch, ncomp, 0, dm_crse_patch);
+
+    m_crse_patch[ncomp] = mf;
+
+    long cnt = 0;
+
+    for (MFIter mfi(*mf); mfi.isValid(); ++mfi)
+        cnt += (*mf)[mfi].nBytes();
+
+    m_crse_patch_bytes   += cnt;
+    m_FPC_stats.bytes    += cnt;
+    m_FPC_stats.bytes_hwm = std::max(m_FPC_stats.bytes_hwm, m_FPC_stats.bytes);
+
+    TrimCrsePatches(this);
+
+    return *mf;
+}
+
+void
+FabArrayBase::FPC::clearCrsePatch () const
+{
+    for (std::map<int,MultiFab*>::iterator it = m_crse_patch.begin(), End = m_crse_patch.end();
+         it != End;
+         ++it)
+    {
+        delete it->second;
+    }
+
+    m_crse_patch.clear();
+
+    m_FPC_stats.bytes -= m_crse_patch_bytes;
+
+    m_crse_patch_bytes = 0;
+}
+
 
 // Given a MultiFab in the compute MPI group, clone its data onto a MultiFab in
 // the sidecar group.
@@ -1729,3 +1805,501 @@ MultiFab::SendMultiFabToSidecars (MultiFab *mf)
     }
 }
 #endif
+
+namespace
+{
+    //
+    // Sum of x(xcomp)*y(ycomp) over bx, a pencil at a time.
+    //
+    Real
+    TileDot (const FArrayBox& x,
+             int              xcomp,
+             const FArrayBox& y,
+             int              ycomp,
+             const Box&       bx)
+    {
+        Box pencils(bx);
+
+        pencils.setBig(0, bx.smallEnd(0));
+
+        const int n = bx.length(0);
+
+        Real r = 0;
+
+        for (IntVect iv = pencils.smallEnd(); iv <= pencils.bigEnd(); pencils.next(iv))
+        {
+            const Real* xp = &x(iv,xcomp);
+            const Real* yp = &y(iv,ycomp);
+
+            for (int i = 0; i < n; ++i)
+                r += xp[i]*yp[i];
+        }
+
+        return r;
+    }
+
+}
+
+#ifdef BL_USE_MPI
+namespace
+{
+    //
+    // The reduction operation of MultiFabReduction.  Each element is a
+    // whole MultiFabReduction buffer; the number of leading slots to sum
+    // is an attribute of its datatype and the rest are maxed.
+    //
+    MPI_Op sum_max_op  = MPI_OP_NULL;
+    int    nsum_keyval = MPI_KEYVAL_INVALID;
+
+    void
+    sum_max (void*         invec,
+             void*         inoutvec,
+             int*          len,
+             MPI_Datatype* dtype)
+    {
+        int* nsum = 0;
+        int  flag = 0;
+        int  size = 0;
+
+        MPI_Type_get_attr(*dtype, nsum_keyval, &nsum, &flag);
+        MPI_Type_size(*dtype, &size);
+
+        BL_ASSERT(flag);
+
+        const int   n   = size / sizeof(Real);
+        const Real* in  = static_cast<const Real*>(invec);
+        Real*       out = static_cast<Real*>(inoutvec);
+
+        for (int e = 0; e < *len; ++e, in += n, out += n)
+        {
+            for (int i = 0; i < *nsum; ++i)
+                out[i] += in[i];
+            for (int i = *nsum; i < n; ++i)
+                out[i] = std::max(out[i], in[i]);
+        }
+    }
+
+    void
+    free_sum_max ()
+    {
+        MPI_Op_free(&sum_max_op);
+        MPI_Type_free_keyval(&nsum_keyval);
+    }
+
+    void
+    init_sum_max ()
+    {
+        if (sum_max_op == MPI_OP_NULL)
+        {
+            BL_MPI_REQUIRE( MPI_Op_create(sum_max, 1, &sum_max_op) );
+            BL_MPI_REQUIRE( MPI_Type_create_keyval(MPI_TYPE_NULL_COPY_FN,
+                                                   MPI_TYPE_NULL_DELETE_FN,
+                                                   &nsum_keyval, 0) );
+            BoxLib::ExecOnFinalize(free_sum_max);
+        }
+    }
+}
+#endif
+
+MultiFabReduction::MultiFabReduction ()
+    :
+    m_nsum(0),
+    m_pending(false),
+    m_done(false)
+#ifdef BL_USE_MPI
+    ,
+    m_req(MPI_REQUEST_NULL),
+    m_type(MPI_DATATYPE_NULL),
+    m_type_len(0),
+    m_type_nsum(0)
+#endif
+{}
+
+MultiFabReduction::~MultiFabReduction ()
+{
+    if (m_pending) wait();
+#ifdef BL_USE_MPI
+    free_type();
+#endif
+}
+
+void
+MultiFabReduction::clear ()
+{
+    if (m_pending) wait();
+#ifdef BL_USE_MPI
+    free_type();
+#endif
+
+    m_items.clear();
+    m_buf.clear();
+    m_result.clear();
+    m_done = false;
+}
+
+int
+MultiFabReduction::add (Kind            kind,
+                        const MultiFab* x,
+                        int             xcomp,
+                        const MultiFab* y,
+                        int             ycomp,
+                        int             nghost)
+{
+    BL_ASSERT(!m_pending);
+    BL_ASSERT(xcomp >= 0 && xcomp < x->nComp());
+    BL_ASSERT(nghost >= 0 && nghost <= x->nGrow());
+
+    if (!m_items.empty())
+    {
+        BL_ASSERT(x->boxArray() == m_items[0].x->boxArray());
+        BL_ASSERT(x->DistributionMap() == m_items[0].x->DistributionMap());
+    }
+
+    Item item;
+
+    item.kind   = kind;
+    item.x      = x;
+    item.xcomp  = xcomp;
+    item.y      = y;
+    item.ycomp  = ycomp;
+    item.nghost = nghost;
+    item.slot   = -1;
+
+    m_items.push_back(item);
+
+    m_done = false;
+
+    return m_items.size() - 1;
+}
+
+int
+MultiFabReduction::addSum (const MultiFab& mf, int comp, int nghost)
+{
+    return add(Sum, &mf, comp, 0, 0, nghost);
+}
+
+int
+MultiFabReduction::addMin (const MultiFab& mf, int comp, int nghost)
+{
+    return add(Min, &mf, comp, 0, 0, nghost);
+}
+
+int
+MultiFabReduction::addMax (const MultiFab& mf, int comp, int nghost)
+{
+    return add(Max, &mf, comp, 0, 0, nghost);
+}
+
+int
+MultiFabReduction::addNorm0 (const MultiFab& mf, int comp, int nghost)
+{
+    return add(Norm0, &mf, comp, 0, 0, nghost);
+}
+
+int
+MultiFabReduction::addNorm1 (const MultiFab& mf, int comp, int nghost)
+{
+    return add(Norm1, &mf, comp, 0, 0, nghost);
+}
+
+int
+MultiFabReduction::addNorm2 (const MultiFab& mf, int comp, int nghost)
+{
+    return add(Norm2, &mf, comp, 0, 0, nghost);
+}
+
+int
+MultiFabReduction::addDot (const MultiFab& x,
+                           int             xcomp,
+                           const MultiFab& y,
+                           int             ycomp,
+                           int             nghost)
+{
+    BL_ASSERT(y.boxArray() == x.boxArray());
+    BL_ASSERT(y.DistributionMap() == x.DistributionMap());
+    BL_ASSERT(ycomp >= 0 && ycomp < y.nComp());
+    BL_ASSERT(nghost <= y.nGrow());
+
+    return add(Dot, &x, xcomp, &y, ycomp, nghost);
+}
+
+void
+MultiFabReduction::local_reduce ()
+{
+    BL_PROFILE("MultiFabReduction::local_reduce()");
+
+    const int N = m_items.size();
+    //
+    // Lay out m_buf: the sums, then the maxima.
+    //
+    int nsum = 0;
+
+    for (int i = 0; i < N; ++i)
+    {
+        const Kind k = m_items[i].kind;
+
+        m_items[i].slot = (k == Sum || k == Norm1 || k == Norm2 || k == Dot) ? nsum++ : -1;
+    }
+
+    int nmax = 0;
+
+    for (int i = 0; i < N; ++i)
+    {
+        if (m_items[i].slot < 0)
+            m_items[i].slot = nsum + nmax++;
+    }
+
+    const Real rmax = std::numeric_limits<Real>::max();
+
+    m_nsum = nsum;
+
+    m_buf.assign(nsum + nmax, 0);
+
+    for (int i = nsum; i < int(m_buf.size()); ++i)
+        m_buf[i] = -rmax;
+
+    if (N == 0) return;
+
+    const MultiFab& mf0 = *m_items[0].x;
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        std::vector<Real> priv(m_buf);
+
+        for (MFIter mfi(mf0,true); mfi.isValid(); ++mfi)
+        {
+            for (int i = 0; i < N; ++i)
+            {
+                const Item&      item = m_items[i];
+                const FArrayBox& fab  = (*item.x)[mfi];
+                Real&            r    = priv[item.slot];
+
+                switch (item.kind)
+                {
+                case Sum:
+                    //
+                    // MultiFab::sum() ignores ghost cells.
+                    //
+                    r += fab.sum(item.nghost > 0 ? mfi.growntilebox(item.nghost) : mfi.tilebox(),
+                                 item.xcomp, 1);
+                    break;
+                case Min:
+                    r = std::max(r, -fab.min(mfi.growntilebox(item.nghost), item.xcomp));
+                    break;
+                case Max:
+                    r = std::max(r, fab.max(mfi.growntilebox(item.nghost), item.xcomp));
+                    break;
+                case Norm0:
+                    r = std::max(r, fab.norm(mfi.growntilebox(item.nghost), 0, item.xcomp, 1));
+                    break;
+                case Norm1:
+                    r += fab.norm(mfi.growntilebox(item.nghost), 1, item.xcomp, 1);
+                    break;
+                case Norm2:
+                    {
+                        const Real nm = fab.norm(mfi.growntilebox(item.nghost), 2, item.xcomp, 1);
+                        r += nm*nm;
+                    }
+                    break;
+                case Dot:
+                    r += TileDot(fab, item.xcomp, (*item.y)[mfi], item.ycomp,
+                                 mfi.growntilebox(item.nghost));
+                    break;
+                }
+            }
+        }
+
+#ifdef _OPENMP
+#pragma omp critical(multifabreduction)
+#endif
+        {
+            for (int i = 0; i < nsum; ++i)
+                m_buf[i] += priv[i];
+            for (int i = nsum; i < int(m_buf.size()); ++i)
+                m_buf[i] = std::max(m_buf[i], priv[i]);
+        }
+    }
+}
+
+void
+MultiFabReduction::reduce (bool local)
+{
+    BL_PROFILE("MultiFabReduction::reduce()");
+
+    BL_ASSERT(!m_pending);
+
+    local_reduce();
+
+#ifdef BL_USE_MPI
+    if (!local && !m_items.empty() && ParallelDescriptor::NProcs() > 1)
+    {
+        const MPI_Comm comm = ParallelDescriptor::Communicator(m_items[0].x->color());
+
+        if (comm != MPI_COMM_NULL)
+        {
+            allreduce(comm, false);
+
+            m_buf.swap(m_recv);
+        }
+    }
+#endif
+
+    finish();
+}
+
+void
+MultiFabReduction::reduce_nowait ()
+{
+#if defined(BL_USE_MPI) && defined(BL_USE_MPI3)
+    BL_PROFILE("MultiFabReduction::reduce_nowait()");
+
+    BL_ASSERT(!m_pending);
+
+    local_reduce();
+
+    if (!m_items.empty() && ParallelDescriptor::NProcs() > 1)
+    {
+        const MPI_Comm comm = ParallelDescriptor::Communicator(m_items[0].x->color());
+
+        if (comm != MPI_COMM_NULL)
+        {
+            allreduce(comm, true);
+
+            m_pending = true;
+            return;
+        }
+    }
+
+    finish();
+#else
+    reduce();
+#endif
+}
+
+void
+MultiFabReduction::wait ()
+{
+#ifdef BL_USE_MPI
+    if (m_pending)
+    {
+        BL_PROFILE("MultiFabReduction::wait()");
+
+        MPI_Status status;
+
+        BL_MPI_REQUIRE( MPI_Wait(&m_req, &status) );
+
+        m_pending = false;
+
+        m_buf.swap(m_recv);
+
+        finish();
+    }
+#endif
+}
+
+#ifdef BL_USE_MPI
+void
+MultiFabReduction::allreduce (MPI_Comm comm,
+                              bool     nowait)
+{
+    const int len  = m_buf.size();
+    const int nmax = len - m_nsum;
+    //
+    // All sums or all maxima need only the predefined operations.
+    //
+    MPI_Datatype typ   = ParallelDescriptor::Mpi_typemap<Real>::type();
+    MPI_Op       op    = (nmax == 0) ? MPI_SUM : MPI_MAX;
+    int          count = len;
+
+    if (m_nsum > 0 && nmax > 0)
+    {
+        init_sum_max();
+
+        if (m_type == MPI_DATATYPE_NULL || m_type_len != len || m_type_nsum != m_nsum)
+        {
+            free_type();
+
+            BL_MPI_REQUIRE( MPI_Type_contiguous(len, typ, &m_type) );
+            BL_MPI_REQUIRE( MPI_Type_commit(&m_type) );
+
+            m_type_len  = len;
+            m_type_nsum = m_nsum;
+
+            BL_MPI_REQUIRE( MPI_Type_set_attr(m_type, nsum_keyval, &m_type_nsum) );
+        }
+
+        typ   = m_type;
+        op    = sum_max_op;
+        count = 1;
+    }
+
+    m_recv.resize(len);
+
+    m_req = MPI_REQUEST_NULL;
+
+    if (nowait)
+    {
+#ifdef BL_USE_MPI3
+        BL_MPI_REQUIRE( MPI_Iallreduce(&m_buf[0], &m_recv[0], count, typ, op, comm, &m_req) );
+#endif
+    }
+    else
+    {
+        BL_MPI_REQUIRE( MPI_Allreduce(&m_buf[0], &m_recv[0], count, typ, op, comm) );
+    }
+}
+
+void
+MultiFabReduction::free_type ()
+{
+    if (m_type != MPI_DATATYPE_NULL)
+    {
+        int finalized = 0;
+
+        MPI_Finalized(&finalized);
+
+        if (!finalized)
+            BL_MPI_REQUIRE( MPI_Type_free(&m_type) );
+
+        m_type = MPI_DATATYPE_NULL;
+    }
+}
+#endif
+
+void
+MultiFabReduction::finish ()
+{
+    const int N = m_items.size();
+
+    m_result.resize(N);
+
+    for (int i = 0; i < N; ++i)
+    {
+        const Real r = m_buf[m_items[i].slot];
+
+        switch (m_items[i].kind)
+        {
+        case Min:
+            m_result[i] = -r;
+            break;
+        case Norm2:
+            m_result[i] = std::sqrt(r);
+            break;
+        default:
+            m_result[i] = r;
+        }
+    }
+
+    m_done = true;
+}
+
+Real
+MultiFabReduction::value (int i) const
+{
+    BL_ASSERT(m_done && !m_pending);
+    BL_ASSERT(i >= 0 && i < int(m_result.size()));
+
+    return m_result[i];
+}
@@ -219,10 +219,7 @@ namespace BoxLib
     {
 	if (mf.nGrow() <= 0) return;
 	
-	bool local = false;  // Don't think we ever want it to be true.
-	mf.FillBoundary(scomp, ncomp, local, cross);
-
 	bool do_corners = !cross;
-	geom.FillPeriodicBoundary(mf, scomp, ncomp, do_corners, local);
+	mf.FillBoundary(scomp, ncomp, geom, cross, do_corners);
     }
 }
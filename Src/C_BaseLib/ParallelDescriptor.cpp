@@ -7,6 +7,7 @@
 #include <sstream>
 #include <stack>
 #include <list>
+#include <map>
 
 #include <Utility.H>
 #include <BLProfiler.H>
@@ -62,6 +63,11 @@ namespace ParallelDescriptor
     int m_nCommColors = 1;
     Color m_MyCommSubColor;
     Color m_MyCommCompColor;
+    //
+    // The communicators of SubsetColor() keyed by their number of processes.
+    // MPI_COMM_NULL on the processes that aren't in them.
+    //
+    std::map<int,MPI_Comm> m_comm_subset;
 
     int m_MinTag = 1000, m_MaxTag = -1;
 
@@ -395,6 +401,50 @@ ParallelDescriptor::EndSubCommunicator ()
     if (m_nCommColors > 1) {
 	MPI_Comm_free(&m_comm_sub);
     }
+
+    for (std::map<int,MPI_Comm>::iterator it = m_comm_subset.begin();
+         it != m_comm_subset.end();
+         ++it)
+    {
+        if (it->second != MPI_COMM_NULL)
+            MPI_Comm_free(&it->second);
+    }
+
+    m_comm_subset.clear();
+}
+
+ParallelDescriptor::Color
+ParallelDescriptor::SubsetColor (int nprocs)
+{
+    BL_ASSERT(nprocs > 0);
+
+    if (nprocs >= NProcs()) return DefaultColor();
+
+    if (m_nCommColors > 1)
+	BoxLib::Abort("ParallelDescriptor::SubsetColor() not supported with boxlib.ncolors > 1");
+
+    if (m_comm_subset.count(nprocs) == 0)
+    {
+        MPI_Comm comm;
+
+        const int in_subset = (MyProc() < nprocs) ? 0 : MPI_UNDEFINED;
+
+        BL_MPI_REQUIRE( MPI_Comm_split(Communicator(), in_subset, MyProc(), &comm) );
+
+        m_comm_subset[nprocs] = comm;
+    }
+
+    return Color(m_nCommColors + nprocs);
+}
+
+MPI_Comm
+ParallelDescriptor::SubsetCommunicator (Color color)
+{
+    std::map<int,MPI_Comm>::const_iterator it = m_comm_subset.find(SubsetNProcs(color));
+
+    BL_ASSERT(it != m_comm_subset.end());
+
+    return it->second;
 }
 
 double
@@ -1605,6 +1655,18 @@ void ParallelDescriptor::EndParallel () {}
 
 void ParallelDescriptor::EndSubCommunicator () {}
 
+ParallelDescriptor::Color
+ParallelDescriptor::SubsetColor (int)
+{
+    return DefaultColor();
+}
+
+MPI_Comm
+ParallelDescriptor::SubsetCommunicator (Color)
+{
+    return m_comm_comp;
+}
+
 void ParallelDescriptor::Abort ()
 { 
 #ifdef WIN32
@@ -1717,9 +1779,23 @@ int
 ParallelDescriptor::SeqNum ()
 {
     static int seqno = m_MinTag;
+
+    const bool share_tags = NColors() > 1 || !m_comm_subset.empty();
+
+    if (share_tags && (seqno - m_MinTag) % 2 != 0) {
+	//
+	// A subset communicator was made since the last call.
+	// The odd offsets from m_MinTag belong to SubSeqNum().
+	//
+	++seqno;
+	if (seqno > m_MaxTag) {
+	    seqno = m_MinTag;
+	}
+    }
+
     int result = seqno;
 
-    if (NColors() == 1) { 
+    if (!share_tags) { 
 	++seqno;
     } else {
 	seqno += 2;
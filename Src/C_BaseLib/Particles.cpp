@@ -880,3 +880,248 @@ operator<< (std::ostream& os, const ParticleBase& p)
 }
 
 ParticleContainerBase::~ParticleContainerBase () {}
+
+namespace
+{
+    //
+    // The layout NeighborProcs() last ran on and what it found.
+    // Redistribute() asks on every call but the grids only change on a
+    // regrid, so we keep a copy of the layout and redo the intersections
+    // only when the one we're asked about differs from it.  Holding the
+    // BoxArrays and DistributionMappings, rather than their reference IDs,
+    // means a new layout can't be mistaken for a freed one.
+    //
+    struct NeighborCache
+    {
+        NeighborCache () : finest_level(-1), periodic(0) {}
+
+        bool matches (const ParGDBBase* gdb, int flev) const;
+
+        void set (const ParGDBBase* gdb, int flev, const std::vector<int>& p);
+
+        void clear ();
+
+        int                        finest_level;
+        int                        periodic;
+        Array<BoxArray>            ba;
+        Array<DistributionMapping> dm;
+        Array<Box>                 domain;
+        Array<IntVect>             ratio;
+        std::vector<int>           procs;
+    };
+
+    NeighborCache nbr_cache;
+
+    bool nbr_cache_initialized = false;
+
+    int
+    periodicity_mask ()
+    {
+        int mask = 0;
+
+        for (int d = 0; d < BL_SPACEDIM; d++)
+            if (Geometry::isPeriodic(d))
+                mask |= (1 << d);
+
+        return mask;
+    }
+
+    bool
+    NeighborCache::matches (const ParGDBBase* gdb, int flev) const
+    {
+        if (flev != finest_level || periodic != periodicity_mask())
+            return false;
+
+        for (int lev = 0; lev <= flev; lev++)
+        {
+            if (gdb->Geom(lev).Domain() != domain[lev])
+                return false;
+
+            if (lev < flev && gdb->refRatio(lev) != ratio[lev])
+                return false;
+
+            if (gdb->ParticleBoxArray(lev)        != ba[lev] ||
+                gdb->ParticleDistributionMap(lev) != dm[lev])
+                return false;
+        }
+
+        return true;
+    }
+
+    void
+    NeighborCache::set (const ParGDBBase* gdb, int flev, const std::vector<int>& p)
+    {
+        finest_level = flev;
+        periodic     = periodicity_mask();
+
+        ba.resize(flev+1);
+        dm.resize(flev+1);
+        domain.resize(flev+1);
+        ratio.resize(flev+1);
+
+        for (int lev = 0; lev <= flev; lev++)
+        {
+            ba[lev]     = gdb->ParticleBoxArray(lev);
+            dm[lev]     = gdb->ParticleDistributionMap(lev);
+            domain[lev] = gdb->Geom(lev).Domain();
+            ratio[lev]  = (lev < flev) ? gdb->refRatio(lev) : IntVect::TheZeroVector();
+        }
+
+        procs = p;
+    }
+
+    void
+    NeighborCache::clear ()
+    {
+        finest_level = -1;
+        ba.clear();
+        dm.clear();
+        domain.clear();
+        ratio.clear();
+        procs.clear();
+    }
+
+    void
+    FlushNeighborCache ()
+    {
+        nbr_cache.clear();
+        nbr_cache_initialized = false;
+    }
+}
+
+bool
+ParticleBase::NeighborRedistribute ()
+{
+    static bool neighbor_redistribute = true;
+
+    static bool first = true;
+
+    if (first)
+    {
+        first = false;
+
+        ParmParse pp("particles");
+
+        pp.query("neighbor_redistribute", neighbor_redistribute);
+    }
+
+    return neighbor_redistribute;
+}
+
+void
+ParticleBase::NeighborProcs (const ParGDBBase* gdb,
+                             int               finest_level,
+                             std::vector<int>& procs)
+{
+    BL_PROFILE("ParticleBase::NeighborProcs()");
+
+    if (nbr_cache.matches(gdb, finest_level))
+    {
+        procs = nbr_cache.procs;
+        return;
+    }
+
+    const int MyProc = ParallelDescriptor::MyProc();
+
+    std::vector<bool> is_nbr(ParallelDescriptor::NProcs(),false);
+
+    std::vector< std::pair<int,Box> > isects;
+
+    Array<IntVect> pshifts;
+
+    for (int lev = 0; lev <= finest_level; lev++)
+    {
+        const BoxArray&            ba = gdb->ParticleBoxArray(lev);
+        const DistributionMapping& dm = gdb->ParticleDistributionMap(lev);
+
+        for (int i = 0, N = ba.size(); i < N; i++)
+        {
+            if (dm[i] != MyProc) continue;
+
+            for (int olev = 0; olev <= finest_level; olev++)
+            {
+                //
+                // Grow by a cell in the coarser of the two index spaces.
+                //
+                IntVect rr = IntVect::TheUnitVector();
+
+                for (int l = std::min(lev,olev); l < std::max(lev,olev); l++)
+                    rr *= gdb->refRatio(l);
+
+                const Box bx = (olev <= lev)
+                    ? BoxLib::grow(BoxLib::coarsen(ba[i],rr),1)
+                    : BoxLib::refine(BoxLib::grow(ba[i],1),rr);
+
+                const Geometry&            ogeom = gdb->Geom(olev);
+                const BoxArray&            oba   = gdb->ParticleBoxArray(olev);
+                const DistributionMapping& odm   = gdb->ParticleDistributionMap(olev);
+
+                pshifts.clear();
+
+                if (ogeom.isAnyPeriodic() && !ogeom.Domain().contains(bx))
+                    ogeom.periodicShift(ogeom.Domain(),bx,pshifts);
+
+                pshifts.push_back(IntVect::TheZeroVector());
+
+                for (int j = 0; j < pshifts.size(); j++)
+                {
+                    oba.intersections(bx+pshifts[j],isects);
+
+                    for (int k = 0, M = isects.size(); k < M; k++)
+                        is_nbr[odm[isects[k].first]] = true;
+                }
+            }
+        }
+    }
+
+    is_nbr[MyProc] = false;
+
+#ifdef BL_USE_MPI
+    //
+    // Redistribute() swaps counts with the neighbors only, so each of ours
+    // must have us as one too.  That holds by construction, but tell every
+    // processor whether it's a neighbor and take the union to be sure.
+    // This is one all-to-all per new layout.
+    //
+    {
+        const int NProcs = ParallelDescriptor::NProcs();
+
+        Array<int> Snds(NProcs,0), Rcvs(NProcs,0);
+
+        for (int i = 0; i < NProcs; i++)
+            Snds[i] = is_nbr[i];
+
+        BL_COMM_PROFILE(BLProfiler::Alltoall, sizeof(int),
+                        ParallelDescriptor::MyProc(), BLProfiler::BeforeCall());
+
+        BL_MPI_REQUIRE( MPI_Alltoall(Snds.dataPtr(),
+                                     1,
+                                     ParallelDescriptor::Mpi_typemap<int>::type(),
+                                     Rcvs.dataPtr(),
+                                     1,
+                                     ParallelDescriptor::Mpi_typemap<int>::type(),
+                                     ParallelDescriptor::Communicator()) );
+
+        BL_COMM_PROFILE(BLProfiler::Alltoall, sizeof(int),
+                        ParallelDescriptor::MyProc(), BLProfiler::AfterCall());
+
+        for (int i = 0; i < NProcs; i++)
+            if (Rcvs[i])
+                is_nbr[i] = true;
+    }
+#endif
+
+    procs.clear();
+
+    for (int i = 0, N = is_nbr.size(); i < N; i++)
+        if (is_nbr[i])
+            procs.push_back(i);
+
+    if (!nbr_cache_initialized)
+    {
+        BoxLib::ExecOnFinalize(FlushNeighborCache);
+        nbr_cache_initialized = true;
+    }
+
+    nbr_cache.set(gdb, finest_level, procs);
+}
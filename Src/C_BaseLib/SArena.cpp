@@ -0,0 +1,480 @@
+
+#include <winstd.H>
+#include <new>
+#include <cstring>
+
+#include <SArena.H>
+#include <BLassert.H>
+
+namespace
+{
+    //
+    // A process-wide number for each thread that calls alloc(), handed out
+    // on first use.  Unlike omp_get_thread_num() it's different for every
+    // thread of nested parallel regions.
+    //
+    int sarena_tid = -1;
+#ifdef _OPENMP
+#pragma omp threadprivate(sarena_tid)
+#endif
+    int sarena_ntids = 0;
+    //
+    // The statistics of a cache are written by the thread that owns it, or
+    // with the lock held for the shared cache, while any thread may read
+    // them, so they are all accessed atomically.
+    //
+    inline void
+    stat_add (long& s, long n)
+    {
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        s += n;
+    }
+
+    inline void
+    stat_write (long& s, long v)
+    {
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+        s = v;
+    }
+
+    inline long
+    stat_read (const long& s)
+    {
+        long r;
+#ifdef _OPENMP
+#pragma omp atomic read
+#endif
+        r = s;
+        return r;
+    }
+}
+
+SArena::SArena (size_t hunk_size,
+                int    nthreads)
+{
+    m_hunk = Arena::align(hunk_size == 0 ? DefaultHunkSize : hunk_size);
+
+    if (nthreads == 0)
+    {
+#ifdef _OPENMP
+        nthreads = omp_get_max_threads();
+#else
+        nthreads = 1;
+#endif
+    }
+
+    BL_ASSERT(nthreads > 0);
+    BL_ASSERT(sizeof(BlockHeader) <= Arena::align_size);
+
+    m_cache.resize(nthreads+1);
+
+    m_shared = nthreads;
+
+    for (int i = 0; i <= nthreads; i++)
+    {
+        //
+        // Allocated separately so the caches don't share cache lines.
+        //
+        Cache* c = new Cache;
+
+        for (int b = 0; b < NBins; b++)
+            c->m_free[b] = 0;
+
+        c->m_remote       = 0;
+        c->m_remote_bytes = 0;
+        c->m_hunk_ptr     = 0;
+        c->m_hunk_left    = 0;
+        c->m_used         = 0;
+        c->m_inuse        = 0;
+        c->m_hwm          = 0;
+#ifdef _OPENMP
+        omp_init_lock(&c->m_lock);
+#endif
+        m_cache[i] = c;
+    }
+
+    m_big_used = 0;
+    m_big_hwm  = 0;
+#ifdef _OPENMP
+    omp_init_lock(&m_big_lock);
+#endif
+}
+
+SArena::~SArena ()
+{
+    for (int i = 0, N = m_cache.size(); i < N; i++)
+    {
+        Cache* c = m_cache[i];
+
+        for (int j = 0, M = c->m_alloc.size(); j < M; j++)
+            ::operator delete(c->m_alloc[j]);
+#ifdef _OPENMP
+        omp_destroy_lock(&c->m_lock);
+#endif
+        delete c;
+    }
+#ifdef _OPENMP
+    omp_destroy_lock(&m_big_lock);
+#endif
+}
+
+int
+SArena::bin (size_t nbytes)
+{
+    //
+    // Multiples of 16 bytes up to 256 bytes.
+    //
+    if (nbytes <= 256)
+        return (nbytes-1) >> 4;
+    //
+    // Then 2^k + j*2^(k-2), j = 1..4, for k = 8, 9, ...
+    //
+    const size_t s = nbytes - 1;
+
+    int k = 8;
+
+    while ((s >> (k+1)) != 0)
+        k++;
+
+    const int j = int((s - (size_t(1) << k)) >> (k-2));
+
+    return 16 + 4*(k-8) + j;
+}
+
+size_t
+SArena::bin_size (int b)
+{
+    if (b < 16)
+        return size_t(b+1) << 4;
+
+    const int k = 8 + (b-16)/4;
+    const int j = (b-16)%4;
+
+    return (size_t(1) << k) + size_t(j+1)*(size_t(1) << (k-2));
+}
+
+int
+SArena::my_cache () const
+{
+#ifdef _OPENMP
+    if (sarena_tid < 0)
+    {
+#pragma omp critical (sarena_tid)
+        sarena_tid = sarena_ntids++;
+    }
+
+    return sarena_tid < m_shared ? sarena_tid : m_shared;
+#else
+    return 0;
+#endif
+}
+
+char*
+SArena::new_block (int b,
+                   int tid)
+{
+    Cache& c = *m_cache[tid];
+
+    const size_t N = Arena::align_size + bin_size(b);
+
+    if (c.m_hunk_left < N)
+    {
+        //
+        // What's left of the current hunk is abandoned.
+        //
+        c.m_hunk_ptr  = static_cast<char*>(::operator new(m_hunk));
+        c.m_hunk_left = m_hunk;
+
+        c.m_alloc.push_back(c.m_hunk_ptr);
+
+        stat_add(c.m_used, m_hunk);
+    }
+
+    char* p = c.m_hunk_ptr;
+
+    c.m_hunk_ptr  += N;
+    c.m_hunk_left -= N;
+
+    BlockHeader* h = reinterpret_cast<BlockHeader*>(p);
+
+    h->m_bin   = b;
+    h->m_owner = tid;
+
+    return p + Arena::align_size;
+}
+
+void*
+SArena::big_alloc (int b)
+{
+    const size_t N = Arena::align_size + bin_size(b);
+
+    char* p = static_cast<char*>(::operator new(N));
+
+    BlockHeader* h = reinterpret_cast<BlockHeader*>(p);
+
+    h->m_bin   = b;
+    h->m_owner = -1;
+
+#ifdef _OPENMP
+    omp_set_lock(&m_big_lock);
+#endif
+    stat_add(m_big_used, N);
+
+    if (m_big_used > m_big_hwm)
+        stat_write(m_big_hwm, m_big_used);
+#ifdef _OPENMP
+    omp_unset_lock(&m_big_lock);
+#endif
+
+    return p + Arena::align_size;
+}
+
+void
+SArena::big_free (void* vp,
+                  int   b)
+{
+    const size_t N = Arena::align_size + bin_size(b);
+
+    ::operator delete(static_cast<char*>(vp) - Arena::align_size);
+
+#ifdef _OPENMP
+    omp_set_lock(&m_big_lock);
+#endif
+    stat_add(m_big_used, -long(N));
+#ifdef _OPENMP
+    omp_unset_lock(&m_big_lock);
+#endif
+}
+
+void
+SArena::drain_remote (Cache& c)
+{
+    void*  list;
+    size_t bytes;
+
+#ifdef _OPENMP
+    omp_set_lock(&c.m_lock);
+#endif
+    list  = c.m_remote;
+    bytes = c.m_remote_bytes;
+
+    c.m_remote       = 0;
+    c.m_remote_bytes = 0;
+    //
+    // Under the lock so heap_space_actually_used() never counts the
+    // blocks as both remote and free.
+    //
+    stat_add(c.m_inuse, -long(bytes));
+#ifdef _OPENMP
+    omp_unset_lock(&c.m_lock);
+#endif
+
+    while (list != 0)
+    {
+        void* next = *static_cast<void**>(list);
+
+        const int b = reinterpret_cast<BlockHeader*>(static_cast<char*>(list) - Arena::align_size)->m_bin;
+
+        *static_cast<void**>(list) = c.m_free[b];
+
+        c.m_free[b] = list;
+
+        list = next;
+    }
+}
+
+void*
+SArena::cache_alloc (int b,
+                     int tid)
+{
+    Cache& c = *m_cache[tid];
+
+    if (c.m_free[b] == 0 && tid != m_shared)
+        drain_remote(c);
+
+    void* vp = c.m_free[b];
+
+    if (vp != 0)
+    {
+        c.m_free[b] = *static_cast<void**>(vp);
+    }
+    else
+    {
+        vp = new_block(b, tid);
+    }
+
+    stat_add(c.m_inuse, bin_size(b));
+
+    if (c.m_inuse > c.m_hwm)
+        stat_write(c.m_hwm, c.m_inuse);
+
+    return vp;
+}
+
+void*
+SArena::alloc (size_t nbytes)
+{
+    const int b = bin(nbytes == 0 ? 1 : nbytes);
+
+    if (is_big(b))
+        return big_alloc(b);
+
+    const int tid = my_cache();
+
+    if (tid != m_shared)
+        return cache_alloc(b, tid);
+
+#ifdef _OPENMP
+    omp_set_lock(&m_cache[tid]->m_lock);
+#endif
+    void* vp = cache_alloc(b, tid);
+#ifdef _OPENMP
+    omp_unset_lock(&m_cache[tid]->m_lock);
+#endif
+
+    return vp;
+}
+
+void
+SArena::free (void* vp)
+{
+    if (vp == 0)
+        //
+        // Allow calls with NULL as allowed by C++ delete.
+        //
+        return;
+
+    const BlockHeader* h = reinterpret_cast<BlockHeader*>(static_cast<char*>(vp) - Arena::align_size);
+
+    const int b     = h->m_bin;
+    const int owner = h->m_owner;
+
+    BL_ASSERT(b >= 0 && b < NBins);
+    BL_ASSERT(owner >= -1 && owner < int(m_cache.size()));
+
+    if (owner < 0)
+    {
+        big_free(vp, b);
+        return;
+    }
+
+    Cache& c = *m_cache[owner];
+
+    if (owner != m_shared && owner == my_cache())
+    {
+        *static_cast<void**>(vp) = c.m_free[b];
+
+        c.m_free[b] = vp;
+
+        stat_add(c.m_inuse, -long(bin_size(b)));
+    }
+    else
+    {
+        //
+        // Blocks of the shared cache go straight back on its free lists;
+        // those of other threads wait on m_remote.
+        //
+#ifdef _OPENMP
+        omp_set_lock(&c.m_lock);
+#endif
+        if (owner == m_shared)
+        {
+            *static_cast<void**>(vp) = c.m_free[b];
+
+            c.m_free[b] = vp;
+
+            stat_add(c.m_inuse, -long(bin_size(b)));
+        }
+        else
+        {
+            *static_cast<void**>(vp) = c.m_remote;
+
+            c.m_remote        = vp;
+            c.m_remote_bytes += bin_size(b);
+        }
+#ifdef _OPENMP
+        omp_unset_lock(&c.m_lock);
+#endif
+    }
+}
+
+void
+SArena::prefill ()
+{
+    const int tid = my_cache();
+
+    if (tid == m_shared) return;
+
+    Cache& c = *m_cache[tid];
+
+    c.m_hunk_ptr  = static_cast<char*>(::operator new(m_hunk));
+    c.m_hunk_left = m_hunk;
+
+    c.m_alloc.push_back(c.m_hunk_ptr);
+
+    stat_add(c.m_used, m_hunk);
+
+    std::memset(c.m_hunk_ptr, 0, m_hunk);
+}
+
+size_t
+SArena::heap_space_used () const
+{
+    long r = stat_read(m_big_used);
+
+    for (int i = 0, N = m_cache.size(); i < N; i++)
+        r += stat_read(m_cache[i]->m_used);
+
+    return r;
+}
+
+size_t
+SArena::heap_space_used (int tid) const
+{
+    BL_ASSERT(tid >= 0 && tid < nThreads());
+
+    return stat_read(m_cache[tid]->m_used);
+}
+
+size_t
+SArena::heap_space_actually_used () const
+{
+    long r = stat_read(m_big_used);
+
+    for (int i = 0, N = m_cache.size(); i < N; i++)
+    {
+        Cache& c = *m_cache[i];
+#ifdef _OPENMP
+        omp_set_lock(&c.m_lock);
+#endif
+        r += stat_read(c.m_inuse) - long(c.m_remote_bytes);
+#ifdef _OPENMP
+        omp_unset_lock(&c.m_lock);
+#endif
+    }
+
+    return r;
+}
+
+size_t
+SArena::heap_space_hwm () const
+{
+    long r = stat_read(m_big_hwm);
+
+    for (int i = 0, N = m_cache.size(); i < N; i++)
+        r += stat_read(m_cache[i]->m_hwm);
+
+    return r;
+}
+
+double
+SArena::fragmentation () const
+{
+    const size_t used = heap_space_used();
+
+    return used == 0 ? 0.0 : 1.0 - double(heap_space_actually_used())/double(used);
+}
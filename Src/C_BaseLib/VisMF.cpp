@@ -6,6 +6,16 @@
 #include <sstream>
 #include <vector>
 #include <deque>
+#include <list>
+#include <map>
+#include <algorithm>
+#include <cstdio>
+#include <cerrno>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 //
 // This MUST be defined if don't have pubsetbuf() in I/O Streams Library.
 //
@@ -22,6 +32,8 @@ static const char* TheMultiFabHdrFileSuffix = "_H";
 
 static const char* TheFabOnDiskPrefix = "FabOnDisk:";
 
+static const char* TheFabFileSuffix = "_D_";
+
 int VisMF::verbose = 1;
 
 //
@@ -29,10 +41,220 @@ int VisMF::verbose = 1;
 //
 int VisMF::nOutFiles(64);
 int VisMF::nMFFileInStreams(1);
+bool VisMF::asyncWrite(false);
+bool VisMF::sharedFile(false);
+bool VisMF::parallelRead(false);
+bool VisMF::useMmap(false);
 
 namespace
 {
     bool initialized = false;
+    //
+    // A streambuf appending to a std::vector<char>.  Used to stage FABs in
+    // memory, in exactly the form they take on disk, for asynchronous writes.
+    //
+    class StagingBuf
+        :
+        public std::streambuf
+    {
+    public:
+        explicit StagingBuf (std::vector<char>& buf) : m_buf(buf) {}
+    protected:
+        virtual int_type overflow (int_type c)
+        {
+            if (!traits_type::eq_int_type(c, traits_type::eof()))
+                m_buf.push_back(traits_type::to_char_type(c));
+            return traits_type::not_eof(c);
+        }
+        virtual std::streamsize xsputn (const char* s, std::streamsize n)
+        {
+            m_buf.insert(m_buf.end(), s, s + n);
+            return n;
+        }
+        //
+        // Only reports the current position, which is always the end.
+        //
+        virtual pos_type seekoff (off_type                off,
+                                  std::ios_base::seekdir  dir,
+                                  std::ios_base::openmode which)
+        {
+            if (off == 0 && dir != std::ios_base::beg && (which & std::ios_base::out))
+                return pos_type(off_type(m_buf.size()));
+            return pos_type(off_type(-1));
+        }
+    private:
+        std::vector<char>& m_buf;
+    };
+    //
+    // A streambuf that only counts the characters written to it.
+    //
+    class CountingBuf
+        :
+        public std::streambuf
+    {
+    public:
+        CountingBuf () : m_count(0) {}
+        long count () const { return m_count; }
+    protected:
+        virtual int_type overflow (int_type c)
+        {
+            if (!traits_type::eq_int_type(c, traits_type::eof()))
+                m_count++;
+            return traits_type::not_eof(c);
+        }
+        virtual std::streamsize xsputn (const char*, std::streamsize n)
+        {
+            m_count += n;
+            return n;
+        }
+        virtual pos_type seekoff (off_type                off,
+                                  std::ios_base::seekdir  dir,
+                                  std::ios_base::openmode which)
+        {
+            if (off == 0 && dir != std::ios_base::beg && (which & std::ios_base::out))
+                return pos_type(off_type(m_count));
+            return pos_type(off_type(-1));
+        }
+    private:
+        long m_count;
+    };
+    //
+    // A read-only streambuf over a range of memory.
+    //
+    class MemoryBuf
+        :
+        public std::streambuf
+    {
+    public:
+        MemoryBuf (const char* p, long n)
+        {
+            char* b = const_cast<char*>(p);
+            setg(b, b, b + n);
+        }
+    protected:
+        virtual pos_type seekoff (off_type                off,
+                                  std::ios_base::seekdir  dir,
+                                  std::ios_base::openmode which)
+        {
+            if (!(which & std::ios_base::in))
+                return pos_type(off_type(-1));
+
+            char* p = (dir == std::ios_base::beg) ? eback() :
+                      (dir == std::ios_base::cur) ? gptr()  : egptr();
+            p += off;
+
+            if (p < eback() || p > egptr())
+                return pos_type(off_type(-1));
+
+            setg(eback(), p, egptr());
+
+            return pos_type(off_type(p - eback()));
+        }
+        virtual pos_type seekpos (pos_type pos, std::ios_base::openmode which)
+        {
+            return seekoff(off_type(pos), std::ios_base::beg, which);
+        }
+    };
+    //
+    // Read n bytes at offset off of the file fd.
+    //
+    bool
+    PReadAll (int fd, char* p, size_t n, off_t off)
+    {
+        while (n > 0)
+        {
+            const ssize_t r = ::pread(fd, p, n, off);
+            if (r < 0 && errno == EINTR) continue;
+            if (r <= 0) return false;
+            p   += r;
+            n   -= r;
+            off += r;
+        }
+        return true;
+    }
+    //
+    // We try to read consecutive FABs in pieces of at most this many bytes.
+    //
+    const long ReadChunkSize = 64*1024*1024;
+    //
+    // Write n bytes at offset off of the file fd.
+    //
+    bool
+    PWriteAll (int fd, const char* p, size_t n, off_t off)
+    {
+        while (n > 0)
+        {
+            const ssize_t r = ::pwrite(fd, p, n, off);
+            if (r < 0)
+            {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            p   += r;
+            n   -= r;
+            off += r;
+        }
+        return true;
+    }
+    //
+    // An outstanding asynchronous write of one data file.  If segs is
+    // empty the file is (re)created with data as its contents, otherwise
+    // consecutive pieces of data of length segs[i].second are written at
+    // offsets segs[i].first of the existing file.
+    //
+    struct AsyncJob
+    {
+        std::string                         filename;
+        std::vector<char>                   data;
+        std::vector< std::pair<long,long> > segs;
+        pthread_t                           thread;
+        bool                                ok;
+    };
+
+    std::list<AsyncJob*> async_jobs;
+
+    void*
+    AsyncWriteJob (void* arg)
+    {
+        AsyncJob* job = static_cast<AsyncJob*>(arg);
+
+        job->ok = false;
+
+        if (job->segs.empty())
+        {
+            if (FILE* fp = std::fopen(job->filename.c_str(), "wb"))
+            {
+                const size_t N = job->data.size();
+
+                job->ok = (N == 0 || std::fwrite(&job->data[0], 1, N, fp) == N);
+                job->ok = (std::fclose(fp) == 0) && job->ok;
+            }
+        }
+        else
+        {
+            const int fd = ::open(job->filename.c_str(), O_WRONLY);
+
+            if (fd >= 0)
+            {
+                const char* p = &job->data[0];
+
+                job->ok = true;
+
+                for (int i = 0, N = job->segs.size(); i < N && job->ok; i++)
+                {
+                    job->ok = PWriteAll(fd, p, job->segs[i].second, job->segs[i].first);
+                    p += job->segs[i].second;
+                }
+                job->ok = (::close(fd) == 0) && job->ok;
+            }
+        }
+        //
+        // Release the staging memory as soon as possible.
+        //
+        std::vector<char>().swap(job->data);
+
+        return 0;
+    }
 }
 
 void
@@ -50,6 +272,9 @@ VisMF::Initialize ()
 
     ParmParse pp("vismf");
     pp.query("v",verbose);
+    pp.query("shared_file",sharedFile);
+    pp.query("parallel_read",parallelRead);
+    pp.query("use_mmap",useMmap);
 
     initialized = true;
 }
@@ -57,9 +282,76 @@ VisMF::Initialize ()
 void
 VisMF::Finalize ()
 {
+    if (!VisMF::AsyncWait())
+        BoxLib::Error("VisMF::Finalize(): asynchronous write failed");
+
     initialized = false;
 }
 
+void
+VisMF::SetAsyncWrite (bool async_write)
+{
+    asyncWrite = async_write;
+}
+
+bool
+VisMF::GetAsyncWrite ()
+{
+    return asyncWrite;
+}
+
+void
+VisMF::SetParallelRead (bool parallel_read)
+{
+    parallelRead = parallel_read;
+}
+
+bool
+VisMF::GetParallelRead ()
+{
+    return parallelRead;
+}
+
+void
+VisMF::SetUseMmap (bool use_mmap)
+{
+    useMmap = use_mmap;
+}
+
+bool
+VisMF::GetUseMmap ()
+{
+    return useMmap;
+}
+
+bool
+VisMF::AsyncWait ()
+{
+    if (async_jobs.empty()) return true;
+
+    BL_PROFILE("VisMF::AsyncWait()");
+
+    bool ok = true;
+
+    for (std::list<AsyncJob*>::iterator it = async_jobs.begin(); it != async_jobs.end(); ++it)
+    {
+        pthread_join((*it)->thread, 0);
+
+        if (!(*it)->ok)
+        {
+            std::cerr << "VisMF::AsyncWait(): writing "
+                      << (*it)->filename << " failed" << std::endl;
+            ok = false;
+        }
+
+        delete *it;
+    }
+
+    async_jobs.clear();
+
+    return ok;
+}
+
 void
 VisMF::SetNOutFiles (int noutfiles)
 {
@@ -267,6 +559,8 @@ operator>> (std::istream&  is,
         hd.m_how = VisMF::OneFilePerCPU; break;
     case VisMF::NFiles:
         hd.m_how = VisMF::NFiles; break;
+    case VisMF::SharedFile:
+        hd.m_how = VisMF::SharedFile; break;
     default:
         BoxLib::Error("Bad case in switch");
     }
@@ -350,7 +644,8 @@ VisMF::GetFab (int fabIndex,
 {
     if (m_pa[ncomp][fabIndex] == 0)
     {
-        m_pa[ncomp][fabIndex] = VisMF::readFAB(fabIndex,m_mfname,m_hdr,ncomp);
+        m_pa[ncomp][fabIndex] = useMmap ? readMappedFAB(fabIndex,ncomp)
+                                        : VisMF::readFAB(fabIndex,m_mfname,m_hdr,ncomp);
     }
     return *m_pa[ncomp][fabIndex];
 }
@@ -678,8 +973,6 @@ VisMF::Write (const MultiFab&    mf,
 {
     BL_ASSERT(mf_name[mf_name.length() - 1] != '/');
 
-    static const char* FabFileSuffix = "_D_";
-
     VisMF::Initialize();
 
     VisMF::Header hdr(mf, how);
@@ -705,12 +998,22 @@ VisMF::Write (const MultiFab&    mf,
         }
     }
 
+    if (how == SharedFile || sharedFile)
+    {
+        hdr.m_how = SharedFile;
+
+        return VisMF::WriteShared(mf, mf_name, hdr);
+    }
+
+    if (asyncWrite)
+        return VisMF::WriteAsync(mf, mf_name, hdr);
+
     long        bytes    = 0;
     const int   MyProc   = ParallelDescriptor::MyProc();
     const int   NProcs   = ParallelDescriptor::NProcs();
     const int   NSets    = (NProcs + (nOutFiles - 1)) / nOutFiles;
     const int   MySet    = MyProc/nOutFiles;
-    std::string FullName = BoxLib::Concatenate(mf_name + FabFileSuffix, MyProc % nOutFiles, 4);
+    std::string FullName = BoxLib::Concatenate(mf_name + TheFabFileSuffix, MyProc % nOutFiles, 4);
 
     const std::string BName = VisMF::BaseName(FullName);
 
@@ -775,7 +1078,250 @@ VisMF::Write (const MultiFab&    mf,
 
 #ifdef BL_USE_MPI
     ParallelDescriptor::Barrier("VisMF::Write");
+#endif
+
+    VisMF::GatherFabOnDisk(mf, mf_name, hdr, nOutFiles);
+
+    bytes += VisMF::WriteHeader(mf_name, hdr);
+
+    return bytes;
+}
+
+long
+VisMF::WriteAsync (const MultiFab&    mf,
+                   const std::string& mf_name,
+                   VisMF::Header&     hdr)
+{
+    BL_PROFILE("VisMF::WriteAsync()");
+
+    long              bytes    = 0;
+    const int         MyProc   = ParallelDescriptor::MyProc();
+    const int         NProcs   = ParallelDescriptor::NProcs();
+    const int         MyFile   = MyProc % nOutFiles;
+    const std::string FullName = BoxLib::Concatenate(mf_name + TheFabFileSuffix, MyFile, 4);
+    const std::string BName    = VisMF::BaseName(FullName);
+
+    AsyncJob* job = new AsyncJob;
+
+    job->filename = FullName;
+
+    long nbytes = 0;
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        nbytes += mf[mfi].box().numPts() * mf.nComp() * sizeof(Real) + 1024;
+    job->data.reserve(nbytes);
+
+    {
+        StagingBuf    buf(job->data);
+        std::ostream  os(&buf);
+
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        {
+            hdr.m_fod[mfi.index()] = VisMF::Write(mf[mfi],BName,os,bytes);
+        }
+        if (!os.good())
+            BoxLib::Error("VisMF::WriteAsync: staging failed");
+    }
+    //
+    // As in Write(), the CPUs sharing a data file follow each other in it
+    // in CPU order.  Here the offsets are worked out up front so they can
+    // all write at the same time.
+    //
+    Array<long> staged(NProcs,0);
+
+    staged[MyProc] = job->data.size();
+
+    ParallelDescriptor::ReduceLongSum(staged.dataPtr(), NProcs);
+
+    long offset = 0, filesize = 0;
+
+    for (int i = MyFile; i < NProcs; i += nOutFiles)
+    {
+        if (i < MyProc) offset += staged[i];
+
+        filesize += staged[i];
+    }
+
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        hdr.m_fod[mfi.index()].m_head += offset;
+
+    if (MyProc < nOutFiles)
+    {
+        const int fd = ::open(FullName.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0666);
+
+        if (fd < 0 || ::ftruncate(fd, filesize) != 0)
+            BoxLib::FileOpenFailed(FullName);
+
+        ::close(fd);
+    }
+
+    ParallelDescriptor::Barrier("VisMF::WriteAsync::create");
+
+    if (!job->data.empty())
+    {
+        job->segs.push_back(std::make_pair(offset, long(job->data.size())));
+
+        if (pthread_create(&job->thread, 0, AsyncWriteJob, job) != 0)
+        {
+            //
+            // No thread to be had; do it ourselves.
+            //
+            AsyncWriteJob(job);
+
+            if (!job->ok)
+                BoxLib::FileOpenFailed(FullName);
+
+            delete job;
+        }
+        else
+        {
+            async_jobs.push_back(job);
+        }
+    }
+    else
+    {
+        delete job;
+    }
+
+    VisMF::GatherFabOnDisk(mf, mf_name, hdr, nOutFiles);
+
+    bytes += VisMF::WriteHeader(mf_name, hdr);
+
+    return bytes;
+}
+
+long
+VisMF::WriteShared (const MultiFab&    mf,
+                    const std::string& mf_name,
+                    VisMF::Header&     hdr)
+{
+    BL_PROFILE("VisMF::WriteShared()");
 
+    const int         N        = mf.size();
+    const std::string FullName = BoxLib::Concatenate(mf_name + TheFabFileSuffix, 0, 4);
+    const std::string BName    = VisMF::BaseName(FullName);
+    //
+    // The on-disk size of each FAB.  For the binary formats this only
+    // depends on the Box and number of components, but the ASCII formats
+    // are variable length, so we simply count what writeOn() produces.
+    //
+    Array<long> fabbytes(N,0);
+    {
+        CountingBuf  buf;
+        std::ostream os(&buf);
+
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        {
+            const long start = buf.count();
+            mf[mfi].writeOn(os);
+            fabbytes[mfi.index()] = buf.count() - start;
+        }
+    }
+
+    ParallelDescriptor::ReduceLongSum(fabbytes.dataPtr(), N);
+    //
+    // The FABs are laid out in BoxArray order.
+    //
+    long offset = 0;
+    for (int i = 0; i < N; i++)
+    {
+        hdr.m_fod[i] = VisMF::FabOnDisk(BName, offset);
+        offset += fabbytes[i];
+    }
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        const int fd = ::open(FullName.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0666);
+
+        if (fd < 0 || ::ftruncate(fd, offset) != 0)
+            BoxLib::FileOpenFailed(FullName);
+
+        ::close(fd);
+    }
+
+    ParallelDescriptor::Barrier("VisMF::WriteShared::create");
+
+    long bytes = 0;
+
+    AsyncJob* job = new AsyncJob;
+
+    job->filename = FullName;
+
+    if (asyncWrite)
+    {
+        long nbytes = 0;
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+            nbytes += fabbytes[mfi.index()];
+        job->data.reserve(nbytes);
+    }
+
+    const int fd = asyncWrite ? -1 : ::open(FullName.c_str(), O_WRONLY);
+
+    if (!asyncWrite && fd < 0)
+        BoxLib::FileOpenFailed(FullName);
+
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        const int  idx   = mfi.index();
+        const long start = job->data.size();
+        {
+            StagingBuf   buf(job->data);
+            std::ostream os(&buf);
+            mf[mfi].writeOn(os);
+        }
+        BL_ASSERT(long(job->data.size()) - start == fabbytes[idx]);
+
+        bytes += fabbytes[idx];
+
+        if (asyncWrite)
+        {
+            job->segs.push_back(std::make_pair(hdr.m_fod[idx].m_head, fabbytes[idx]));
+        }
+        else
+        {
+            //
+            // Write each FAB as soon as it's staged so we only need room for one.
+            //
+            if (!PWriteAll(fd, &job->data[0], job->data.size(), hdr.m_fod[idx].m_head))
+                BoxLib::Error("VisMF::WriteShared: pwrite() failed");
+            job->data.clear();
+        }
+    }
+
+    if (asyncWrite && !job->segs.empty() &&
+        pthread_create(&job->thread, 0, AsyncWriteJob, job) == 0)
+    {
+        async_jobs.push_back(job);
+    }
+    else
+    {
+        if (asyncWrite && !job->segs.empty())
+        {
+            AsyncWriteJob(job);
+
+            if (!job->ok)
+                BoxLib::FileOpenFailed(FullName);
+        }
+        if (fd >= 0) ::close(fd);
+
+        delete job;
+    }
+
+    if (!asyncWrite)
+        ParallelDescriptor::Barrier("VisMF::WriteShared");
+
+    bytes += VisMF::WriteHeader(mf_name, hdr);
+
+    return bytes;
+}
+
+void
+VisMF::GatherFabOnDisk (const MultiFab&    mf,
+                        const std::string& mf_name,
+                        VisMF::Header&     hdr,
+                        int                nfiles)
+{
+#ifdef BL_USE_MPI
+    const int NProcs = ParallelDescriptor::NProcs();
     const int IOProc = ParallelDescriptor::IOProcessorNumber();
 
     Array<int> nmtags(NProcs,0);
@@ -832,7 +1378,7 @@ VisMF::Write (const MultiFab&    mf,
 
             hdr.m_fod[j].m_head = recvdata[offset[i]+cnt[i]];
 
-            std::string name = BoxLib::Concatenate(mf_name + FabFileSuffix, i % nOutFiles, 4);
+            std::string name = BoxLib::Concatenate(mf_name + TheFabFileSuffix, i % nfiles, 4);
 
             hdr.m_fod[j].m_name = VisMF::BaseName(name);
 
@@ -840,16 +1386,14 @@ VisMF::Write (const MultiFab&    mf,
         }
     }
 #endif /*BL_USE_MPI*/
-
-    bytes += VisMF::WriteHeader(mf_name, hdr);
-
-    return bytes;
 }
 
 VisMF::VisMF (const std::string& mf_name)
     :
     m_mfname(mf_name)
 {
+    VisMF::Initialize();
+
     std::string FullHdrFileName = m_mfname;
 
     FullHdrFileName += TheMultiFabHdrFileSuffix;
@@ -874,6 +1418,104 @@ VisMF::VisMF (const std::string& mf_name)
     }
 }
 
+VisMF::~VisMF ()
+{
+    for (std::map< std::string, std::pair<char*,long> >::iterator it = m_mapped.begin();
+         it != m_mapped.end();
+         ++it)
+    {
+        if (it->second.second > 0)
+            ::munmap(it->second.first, it->second.second);
+    }
+}
+
+FArrayBox*
+VisMF::readMappedFAB (int idx,
+                      int ncomp) const
+{
+    std::string FullName = VisMF::DirName(m_mfname);
+
+    FullName += m_hdr.m_fod[idx].m_name;
+
+    std::map< std::string, std::pair<char*,long> >::iterator it = m_mapped.find(FullName);
+
+    if (it == m_mapped.end())
+    {
+        const int fd = ::open(FullName.c_str(), O_RDONLY);
+
+        struct stat st;
+
+        if (fd < 0 || ::fstat(fd, &st) != 0)
+            BoxLib::FileOpenFailed(FullName);
+
+        //
+        // mmap() fails on a zero length, so an empty file maps to nothing.
+        //
+        void* addr = 0;
+
+        if (st.st_size > 0)
+            addr = ::mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+        ::close(fd);
+
+        if (addr == MAP_FAILED)
+            BoxLib::Error("VisMF::readMappedFAB: mmap() failed");
+
+        it = m_mapped.insert(std::make_pair(FullName,
+                                            std::make_pair(static_cast<char*>(addr),
+                                                           long(st.st_size)))).first;
+    }
+
+    const long offset = m_hdr.m_fod[idx].m_head;
+
+    if (offset >= it->second.second)
+    {
+        std::string msg("VisMF::readMappedFAB: FAB lies past the end of ");
+        msg += FullName;
+        BoxLib::Error(msg.c_str());
+    }
+
+    MemoryBuf    buf(it->second.first + offset, it->second.second - offset);
+    std::istream is(&buf);
+
+    Box fab_box = m_hdr.m_ba[idx];
+
+    if (m_hdr.m_ngrow)
+        fab_box.grow(m_hdr.m_ngrow);
+
+    FArrayBox* fab = new FArrayBox(fab_box, ncomp == -1 ? m_hdr.m_ncomp : 1);
+
+    if (ncomp == -1)
+    {
+        fab->readFrom(is);
+    }
+    else
+    {
+        fab->readFrom(is, ncomp);
+    }
+
+    return fab;
+}
+
+void
+VisMF::fillFab (FArrayBox& dest,
+                int        comp,
+                int        destcomp) const
+{
+    BL_ASSERT(0 <= comp && comp < m_hdr.m_ncomp);
+
+    std::vector< std::pair<int,Box> > isects;
+
+    m_hdr.m_ba.intersections(dest.box(), isects);
+
+    for (int i = 0, N = isects.size(); i < N; i++)
+    {
+        const Box& bx = isects[i].second;
+
+        dest.copy(GetFab(isects[i].first, comp), bx, 0, bx, destcomp, 1);
+    }
+}
+
 FArrayBox*
 VisMF::readFAB (int                  idx,
                 const std::string&   mf_name,
@@ -950,6 +1592,109 @@ VisMF::readFAB (MultiFab&            mf,
     ifs.close();
 }
 
+void
+VisMF::readFABs (MultiFab&            mf,
+                 const int*           idx,
+                 int                  n,
+                 const std::string&   mf_name,
+                 const VisMF::Header& hdr)
+{
+    if (n == 0) return;
+
+    BL_PROFILE("VisMF::readFABs()");
+
+    const std::string& fname = hdr.m_fod[idx[0]].m_name;
+
+    std::string FullName = VisMF::DirName(mf_name);
+
+    FullName += fname;
+
+    const int fd = ::open(FullName.c_str(), O_RDONLY);
+
+    struct stat st;
+
+    if (fd < 0 || ::fstat(fd, &st) != 0)
+        BoxLib::FileOpenFailed(FullName);
+    //
+    // A FAB ends where the next one in the same file starts.
+    //
+    std::vector<long> starts;
+
+    for (int i = 0, N = hdr.m_fod.size(); i < N; i++)
+        if (hdr.m_fod[i].m_name == fname)
+            starts.push_back(hdr.m_fod[i].m_head);
+
+    starts.push_back(st.st_size);
+
+    std::sort(starts.begin(), starts.end());
+
+    std::vector< std::pair<long,int> > fabs(n);
+
+    for (int i = 0; i < n; i++)
+    {
+        BL_ASSERT(hdr.m_fod[idx[i]].m_name == fname);
+        fabs[i] = std::make_pair(hdr.m_fod[idx[i]].m_head, idx[i]);
+    }
+
+    std::sort(fabs.begin(), fabs.end());
+
+    std::vector<long> ends(n);
+
+    for (int i = 0; i < n; i++)
+        ends[i] = *std::upper_bound(starts.begin(), starts.end(), fabs[i].first);
+
+    std::vector<char> buffer;
+
+    for (int i = 0; i < n; )
+    {
+        //
+        // Read FABs i..j-1, which are adjacent in the file, in one go.
+        //
+        int j = i + 1;
+
+        while (j < n && fabs[j].first == ends[j-1] && ends[j] - fabs[i].first <= ReadChunkSize)
+            j++;
+
+        const long chunk_start = fabs[i].first;
+        const long chunk_size  = ends[j-1] - chunk_start;
+
+        buffer.resize(chunk_size);
+
+        if (chunk_size > 0 && !PReadAll(fd, &buffer[0], chunk_size, chunk_start))
+            BoxLib::Error("VisMF::readFABs: pread() failed");
+
+        for (int k = i; k < j; k++)
+        {
+            MemoryBuf    buf(&buffer[0] + (fabs[k].first - chunk_start), ends[k] - fabs[k].first);
+            std::istream is(&buf);
+
+            mf[fabs[k].second].readFrom(is);
+        }
+
+        i = j;
+    }
+
+    ::close(fd);
+}
+
+void
+VisMF::readLocalFABs (MultiFab&            mf,
+                      const std::string&   mf_name,
+                      const VisMF::Header& hdr)
+{
+    std::map< std::string, std::vector<int> > byfile;
+
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        byfile[hdr.m_fod[mfi.index()].m_name].push_back(mfi.index());
+
+    for (std::map< std::string, std::vector<int> >::const_iterator it = byfile.begin();
+         it != byfile.end();
+         ++it)
+    {
+        VisMF::readFABs(mf, &it->second[0], it->second.size(), mf_name, hdr);
+    }
+}
+
 void
 VisMF::Read (MultiFab&          mf,
              const std::string& mf_name)
@@ -1006,6 +1751,15 @@ VisMF::Read (MultiFab&          mf,
     }
     mf.define(hdr.m_ba, hdr.m_ncomp, hdr.m_ngrow, Fab_allocate);
 
+    if (parallelRead)
+    {
+        VisMF::readLocalFABs(mf, mf_name, hdr);
+
+        BL_ASSERT(mf.ok());
+
+        return;
+    }
+
 #ifdef BL_USE_MPI
     //
     // Here we limit the number of open files when reading a multifab.
@@ -1023,7 +1777,7 @@ VisMF::Read (MultiFab&          mf,
     std::multiset<int> availableFiles;  // [whichFile]  supports multiple reads/file
     int nOpensPerFile(nMFFileInStreams), allReadsIndex(0), messTotal(0);
     ParallelDescriptor::Message rmess;
-    Array<std::map<int,std::map<int,int> > > allReads; // [file]<proc,<seek,index>>
+    Array<std::map<int,std::map<long,int> > > allReads; // [file]<proc,<seek,index>>
 
     for(int i(0); i < nBoxes; ++i) {   // count the files
       int whichProc(mf.DistributionMap()[i]);
@@ -1047,7 +1801,8 @@ VisMF::Read (MultiFab&          mf,
         }
       }
       allReads.resize(nFiles);
-      int whichProc, iSeekPos;
+      int whichProc;
+      long iSeekPos;
       std::map<std::string, int>::iterator fileNamesIter;
       for(int i(0); i < nBoxes; ++i) {   // fill allReads maps
         whichProc = mf.DistributionMap()[i];
@@ -1056,7 +1811,7 @@ VisMF::Read (MultiFab&          mf,
 	fileNamesIter = fileNames.find(fname);
 	if(fileNamesIter != fileNames.end()) {
 	  int findex(fileNames.find(fname)->second);
-	  allReads[findex][whichProc].insert(std::pair<int, int>(iSeekPos, i));
+	  allReads[findex][whichProc].insert(std::pair<long, int>(iSeekPos, i));
 	} else {
 	  std::cout << "**** Error:  filename not found = " << fname << std::endl;
 	  BoxLib::Abort();
@@ -1080,7 +1835,7 @@ VisMF::Read (MultiFab&          mf,
             aFilesIter = availableFiles.begin();
 	    continue;
 	  }
-          std::map<int,std::map<int,int> >::iterator whichRead;
+          std::map<int,std::map<long,int> >::iterator whichRead;
 	  for(whichRead = allReads[arIndex].begin();
 	      whichRead != allReads[arIndex].end(); ++whichRead)
 	  {
@@ -1090,7 +1845,7 @@ VisMF::Read (MultiFab&          mf,
 	      int nReads(whichRead->second.size());
 	      int ir(0);
 	      vReads.resize(nReads);
-              std::map<int,int>::iterator imiter;
+              std::map<long,int>::iterator imiter;
 	      for(imiter = whichRead->second.begin();
 	          imiter != whichRead->second.end(); ++imiter)
 	      {
@@ -1154,10 +1909,10 @@ VisMF::Read (MultiFab&          mf,
       std::vector<int> recReads(nReqs);
       while(nReqs > 0) {
         rmess = ParallelDescriptor::Recv(recReads, ioProcNum, MPI_ANY_TAG);
-        for(int ir(0); ir < rmess.count(); ++ir) {
-	  int mfIndex(recReads[ir]);
-	  VisMF::readFAB(mf,mfIndex, mf_name, hdr);
-	}
+        //
+        // These are all in the same file.
+        //
+        VisMF::readFABs(mf, &recReads[0], rmess.count(), mf_name, hdr);
         nReqs -= rmess.count();
 	iDone[iDoneIndex] = recReads[0];
 	iDone[iDoneCount] = rmess.count();
@@ -1204,10 +1959,7 @@ VisMF::Read (MultiFab&          mf,
                 << totalTime << std::endl;
     }
 #else
-    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
-    {
-	VisMF::readFAB(mf,mfi.index(), mf_name, hdr);
-    }
+    VisMF::readLocalFABs(mf, mf_name, hdr);
 #endif
 
     BL_ASSERT(mf.ok());
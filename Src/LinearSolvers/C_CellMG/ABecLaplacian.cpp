@@ -1,5 +1,6 @@
 #include <winstd.H>
 #include <algorithm>
+#include <typeinfo>
 #include <ABecLaplacian.H>
 #include <ABec_F.H>
 #include <ParallelDescriptor.H>
@@ -106,6 +107,31 @@ ABecLaplacian::norm (int nm, int level, const bool local)
     return res;
 }
 
+LinOp*
+ABecLaplacian::makeAgglomerated (const BndryData& bd,
+                                 int              level)
+{
+    if (typeid(*this) != typeid(ABecLaplacian)) return 0;
+
+    prepareForLevel(level);
+
+    ABecLaplacian* op = new ABecLaplacian(bd, h[level]);
+
+    op->harmavg  = harmavg;
+    op->maxorder = maxorder;
+
+    op->setScalars(alpha, beta);
+    //
+    // Parallel copies, since the grids and distribution differ.
+    //
+    op->acoefs[0]->copy(*acoefs[level]);
+
+    for (int i = 0; i < BL_SPACEDIM; ++i)
+        op->bcoefs[0][i]->copy(*bcoefs[level][i]);
+
+    return op;
+}
+
 void
 ABecLaplacian::clearToLevel (int level)
 {
@@ -613,6 +639,90 @@ ABecLaplacian::Fsmooth_jacobi (MultiFab&       solnL,
     }
 }
 
+bool
+ABecLaplacian::residualRestrict (MultiFab&       crseResL,
+                                 const MultiFab& rhsL,
+                                 MultiFab&       solnL,
+                                 int             level,
+                                 LinOp::BC_Mode  bc_mode)
+{
+    BL_PROFILE("ABecLaplacian::residualRestrict()");
+
+#if (BL_SPACEDIM == 1)
+    return false;
+#endif
+
+    BL_ASSERT(crseResL.nComp() == 1);
+    BL_ASSERT(crseResL.DistributionMap() == solnL.DistributionMap());
+
+    applyBC(solnL, 0, 1, level, bc_mode);
+
+    const MultiFab& a = aCoefficients(level);
+
+    D_TERM(const MultiFab& bX = bCoefficients(0,level);,
+           const MultiFab& bY = bCoefficients(1,level);,
+           const MultiFab& bZ = bCoefficients(2,level););
+
+    const int nc = 1;
+
+    const bool tiling = true;
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter cmfi(crseResL,tiling); cmfi.isValid(); ++cmfi)
+    {
+        BL_ASSERT(BoxLib::coarsen(gbox[level][cmfi.index()],2) == cmfi.validbox());
+
+        const Box&       tbx    = cmfi.tilebox();
+        FArrayBox&       cfab   = crseResL[cmfi];
+        const FArrayBox& rhsfab = rhsL[cmfi];
+        const FArrayBox& xfab   = solnL[cmfi];
+        const FArrayBox& afab   = a[cmfi];
+
+        D_TERM(const FArrayBox& bxfab = bX[cmfi];,
+               const FArrayBox& byfab = bY[cmfi];,
+               const FArrayBox& bzfab = bZ[cmfi];);
+
+#if (BL_SPACEDIM == 2)
+        FORT_RESIDAVG(cfab.dataPtr(),
+                      ARLIM(cfab.loVect()), ARLIM(cfab.hiVect()),
+                      rhsfab.dataPtr(),
+                      ARLIM(rhsfab.loVect()), ARLIM(rhsfab.hiVect()),
+                      xfab.dataPtr(),
+                      ARLIM(xfab.loVect()), ARLIM(xfab.hiVect()),
+                      &alpha, &beta, afab.dataPtr(),
+                      ARLIM(afab.loVect()), ARLIM(afab.hiVect()),
+                      bxfab.dataPtr(),
+                      ARLIM(bxfab.loVect()), ARLIM(bxfab.hiVect()),
+                      byfab.dataPtr(),
+                      ARLIM(byfab.loVect()), ARLIM(byfab.hiVect()),
+                      tbx.loVect(), tbx.hiVect(), &nc,
+                      h[level]);
+#endif
+#if (BL_SPACEDIM == 3)
+        FORT_RESIDAVG(cfab.dataPtr(),
+                      ARLIM(cfab.loVect()), ARLIM(cfab.hiVect()),
+                      rhsfab.dataPtr(),
+                      ARLIM(rhsfab.loVect()), ARLIM(rhsfab.hiVect()),
+                      xfab.dataPtr(),
+                      ARLIM(xfab.loVect()), ARLIM(xfab.hiVect()),
+                      &alpha, &beta, afab.dataPtr(),
+                      ARLIM(afab.loVect()), ARLIM(afab.hiVect()),
+                      bxfab.dataPtr(),
+                      ARLIM(bxfab.loVect()), ARLIM(bxfab.hiVect()),
+                      byfab.dataPtr(),
+                      ARLIM(byfab.loVect()), ARLIM(byfab.hiVect()),
+                      bzfab.dataPtr(),
+                      ARLIM(bzfab.loVect()), ARLIM(bzfab.hiVect()),
+                      tbx.loVect(), tbx.hiVect(), &nc,
+                      h[level]);
+#endif
+    }
+
+    return true;
+}
+
 #include <fstream>
 void
 ABecLaplacian::Fapply (MultiFab&       y,
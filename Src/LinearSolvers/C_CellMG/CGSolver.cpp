@@ -78,10 +78,12 @@ CGSolver::Initialize ()
     {
         switch (ii)
         {
-        case 0: def_cg_solver = CG;             break;
-        case 1: def_cg_solver = BiCGStab;       break;
-        case 2: def_cg_solver = CABiCGStab;     break;
-        case 3: def_cg_solver = CABiCGStabQuad; break;
+        case 0: def_cg_solver = CG;                break;
+        case 1: def_cg_solver = BiCGStab;          break;
+        case 2: def_cg_solver = CABiCGStab;        break;
+        case 3: def_cg_solver = CABiCGStabQuad;    break;
+        case 4: def_cg_solver = PipelinedCG;       break;
+        case 5: def_cg_solver = PipelinedBiCGStab; break;
         default:
             BoxLib::Error("CGSolver::Initialize(): bad cg_solver");
         }
@@ -121,6 +123,7 @@ CGSolver::CGSolver (LinOp& _lp,
     Initialize();
     maxiter = def_maxiter;
     verbose = def_verbose;
+    cg_solver = def_cg_solver;
     set_mg_precond();
 }
 
@@ -163,7 +166,7 @@ CGSolver::solve (MultiFab&       sol,
                  Real            eps_abs,
                  LinOp::BC_Mode  bc_mode)
 {
-    switch (def_cg_solver)
+    switch (cg_solver)
     {
     case CG:
         return solve_cg(sol, rhs, eps_rel, eps_abs, bc_mode);
@@ -171,6 +174,10 @@ CGSolver::solve (MultiFab&       sol,
         return solve_bicgstab(sol, rhs, eps_rel, eps_abs, bc_mode);
     case CABiCGStab:
         return solve_cabicgstab(sol, rhs, eps_rel, eps_abs, bc_mode);
+    case PipelinedCG:
+        return solve_pipelined_cg(sol, rhs, eps_rel, eps_abs, bc_mode);
+    case PipelinedBiCGStab:
+        return solve_pipelined_bicgstab(sol, rhs, eps_rel, eps_abs, bc_mode);
 #ifdef XBLAS
     case CABiCGStabQuad:
         return solve_cabicgstab_quad(sol, rhs, eps_rel, eps_abs, bc_mode);
@@ -1784,6 +1791,491 @@ CGSolver::solve_cg (MultiFab&       sol,
     return ret;
 }
 
+void
+CGSolver::precond (MultiFab&       z,
+                   const MultiFab& r,
+                   Real            eps_rel,
+                   Real            eps_abs)
+{
+    const LinOp::BC_Mode temp_bc_mode = LinOp::Homogeneous_BC;
+
+    if ( use_mg_precond )
+    {
+        z.setVal(0);
+        mg_precond->solve(z, r, eps_rel, eps_abs, temp_bc_mode);
+    }
+    else if ( use_jacobi_precond )
+    {
+        z.setVal(0);
+        Lp.jacobi_smooth(z, r, lev, temp_bc_mode);
+    }
+    else
+    {
+        MultiFab::Copy(z,r,0,0,1,0);
+    }
+}
+
+//
+// Pipelined preconditioned CG (Ghysels & Vanroose, Parallel Computing 40, 2014).
+//
+// Besides the usual r, p and sol we carry u = M^{-1}r, w = Au, s = Ap,
+// q = M^{-1}s and z = Aq, all updated by recurrences.  Each iteration
+// needs (r,u), (w,u) and the norms for the convergence test; these are
+// reduced together while m = M^{-1}w and n = Am are computed.  The
+// residual tested at the top of an iteration is that of the previous
+// update, so the final operator application is wasted.
+//
+int
+CGSolver::solve_pipelined_cg (MultiFab&       sol,
+                              const MultiFab& rhs,
+                              Real            eps_rel,
+                              Real            eps_abs,
+                              LinOp::BC_Mode  bc_mode)
+{
+    BL_PROFILE("CGSolver::solve_pipelined_cg()");
+
+    const int nghost = sol.nGrow(), ncomp = 1;
+
+    const BoxArray& ba = sol.boxArray();
+    const DistributionMapping& dm = sol.DistributionMap();
+
+    BL_ASSERT(sol.nComp() == ncomp);
+    BL_ASSERT(sol.boxArray() == Lp.boxArray(lev));
+    BL_ASSERT(rhs.boxArray() == Lp.boxArray(lev));
+
+    MultiFab u(ba, ncomp, nghost, dm);
+    MultiFab m(ba, ncomp, nghost, dm);
+
+    MultiFab sorig(ba, ncomp, 0, dm);
+    MultiFab r    (ba, ncomp, 0, dm);
+    MultiFab w    (ba, ncomp, 0, dm);
+    MultiFab n    (ba, ncomp, 0, dm);
+    MultiFab p    (ba, ncomp, 0, dm);
+    MultiFab s    (ba, ncomp, 0, dm);
+    MultiFab q    (ba, ncomp, 0, dm);
+    MultiFab z    (ba, ncomp, 0, dm);
+
+    Lp.residual(r, rhs, sol, lev, bc_mode);
+
+    MultiFab::Copy(sorig,sol,0,0,1,0);
+
+    sol.setVal(0);
+
+    const LinOp::BC_Mode temp_bc_mode = LinOp::Homogeneous_BC;
+
+    Real vals[2] = { norm_inf(r, true), Lp.norm(0, lev, true) };
+
+    ParallelDescriptor::ReduceRealMax(vals,2,color());
+
+    Real       rnorm    = vals[0];
+    const Real Lp_norm  = vals[1];
+    const Real rnorm0   = rnorm;
+    Real       minrnorm = rnorm;
+    Real       sol_norm = 0;
+
+    if ( verbose > 0 && ParallelDescriptor::IOProcessor(color()) )
+    {
+        Spacer(std::cout, lev);
+        std::cout << "     PipelinedCG: Initial error :        " << rnorm0 << '\n';
+    }
+
+    if ( rnorm == 0 || rnorm < eps_abs )
+    {
+        if ( verbose > 0 && ParallelDescriptor::IOProcessor(color()) )
+        {
+            Spacer(std::cout, lev);
+            std::cout << "     PipelinedCG: niter = 0,"
+                      << ", rnorm = " << rnorm
+                      << ", eps_abs = " << eps_abs << std::endl;
+        }
+        return 0;
+    }
+
+    precond(u, r, eps_rel, eps_abs);
+    Lp.apply(w, u, lev, temp_bc_mode);
+
+    MultiFabReduction red;
+
+    const int i_gamma = red.addDot(r,0,u,0);
+    const int i_delta = red.addDot(w,0,u,0);
+    const int i_rnorm = red.addNorm0(r,0);
+    const int i_snorm = red.addNorm0(sol,0);
+
+    Real gamma_1 = 0, alpha = 0;
+    int  ret     = 0;
+    int  nit     = 0;
+
+    for (;; ++nit)
+    {
+        red.reduce_nowait();
+
+        precond(m, w, eps_rel, eps_abs);
+        Lp.apply(n, m, lev, temp_bc_mode);
+
+        red.wait();
+
+        rnorm    = red[i_rnorm];
+        sol_norm = red[i_snorm];
+
+        if ( verbose > 2 && nit > 0 && ParallelDescriptor::IOProcessor(color()) )
+        {
+            Spacer(std::cout, lev);
+            std::cout << "     PipelinedCG: Iteration"
+                      << std::setw(4) << nit
+                      << " rel. err. "
+                      << rnorm/(rnorm0) << '\n';
+        }
+
+#ifdef CG_USE_OLD_CONVERGENCE_CRITERIA
+        if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs ) break;
+#else
+        if ( rnorm < eps_rel*(Lp_norm*sol_norm + rnorm0) || rnorm < eps_abs ) break;
+#endif
+        if ( rnorm > def_unstable_criterion*minrnorm )
+        {
+            ret = 2; break;
+        }
+        else if ( rnorm < minrnorm )
+        {
+            minrnorm = rnorm;
+        }
+
+        if ( nit == maxiter ) break;
+
+        const Real gamma = red[i_gamma];
+        const Real delta = red[i_delta];
+
+        Real beta = 0, denom = delta;
+
+        if ( nit > 0 )
+        {
+            beta   = gamma/gamma_1;
+            denom -= beta*gamma/alpha;
+        }
+        if ( denom == 0 )
+        {
+            ret = 1; break;
+        }
+        alpha = gamma/denom;
+
+        if ( nit == 0 )
+        {
+            MultiFab::Copy(z,n,0,0,1,0);
+            MultiFab::Copy(q,m,0,0,1,0);
+            MultiFab::Copy(s,w,0,0,1,0);
+            MultiFab::Copy(p,u,0,0,1,0);
+        }
+        else
+        {
+            sxay(z, n, beta, z);
+            sxay(q, m, beta, q);
+            sxay(s, w, beta, s);
+            sxay(p, u, beta, p);
+        }
+        sxay(sol, sol,  alpha, p);
+        sxay(  r,   r, -alpha, s);
+        sxay(  u,   u, -alpha, q);
+        sxay(  w,   w, -alpha, z);
+
+        gamma_1 = gamma;
+    }
+
+    if ( verbose > 0 && ParallelDescriptor::IOProcessor(color()) )
+    {
+        Spacer(std::cout, lev);
+        std::cout << "     PipelinedCG: Final Iteration"
+                  << std::setw(4) << nit
+                  << " rel. err. "
+                  << rnorm/(rnorm0) << '\n';
+    }
+
+#ifdef CG_USE_OLD_CONVERGENCE_CRITERIA
+    if ( ret == 0 && rnorm > eps_rel*rnorm0 && rnorm > eps_abs )
+#else
+    if ( ret == 0 && rnorm > eps_rel*(Lp_norm*sol_norm + rnorm0) && rnorm > eps_abs )
+#endif
+    {
+        if ( ParallelDescriptor::IOProcessor(color()) )
+            BoxLib::Warning("CGSolver_pipelined_cg: failed to converge!");
+        ret = 8;
+    }
+
+    if ( ( ret == 0 || ret == 8 ) && (rnorm < rnorm0) )
+    {
+        sol.plus(sorig, 0, 1, 0);
+    }
+    else
+    {
+        sol.setVal(0);
+        sol.plus(sorig, 0, 1, 0);
+    }
+
+    return ret;
+}
+
+//
+// Pipelined BiCGStab (Cools & Vanroose, Parallel Computing 65, 2017),
+// right preconditioned.
+//
+// The recurrences are those of the unpreconditioned method applied to
+// A M^{-1}, with w = A M^{-1} r, t = A M^{-1} w, s = A M^{-1} p,
+// z = A M^{-1} s and v = A M^{-1} z.  For the solution update we also
+// carry the preconditioned u = M^{-1} r, pu = M^{-1} p, sm = M^{-1} s
+// and qu = M^{-1} q.  BiCGStab has two synchronization points per
+// iteration; at each, all the needed dot products and norms are reduced
+// together while the next operator and preconditioner are applied.
+//
+int
+CGSolver::solve_pipelined_bicgstab (MultiFab&       sol,
+                                    const MultiFab& rhs,
+                                    Real            eps_rel,
+                                    Real            eps_abs,
+                                    LinOp::BC_Mode  bc_mode)
+{
+    BL_PROFILE("CGSolver::solve_pipelined_bicgstab()");
+
+    const int nghost = sol.nGrow(), ncomp = 1;
+
+    const BoxArray& ba = sol.boxArray();
+    const DistributionMapping& dm = sol.DistributionMap();
+
+    BL_ASSERT(sol.nComp() == ncomp);
+    BL_ASSERT(sol.boxArray() == Lp.boxArray(lev));
+    BL_ASSERT(rhs.boxArray() == Lp.boxArray(lev));
+
+    MultiFab u (ba, ncomp, nghost, dm);
+    MultiFab wm(ba, ncomp, nghost, dm);
+    MultiFab zm(ba, ncomp, nghost, dm);
+
+    MultiFab sorig(ba, ncomp, 0, dm);
+    MultiFab r    (ba, ncomp, 0, dm);
+    MultiFab rh   (ba, ncomp, 0, dm);
+    MultiFab w    (ba, ncomp, 0, dm);
+    MultiFab t    (ba, ncomp, 0, dm);
+    MultiFab p    (ba, ncomp, 0, dm);
+    MultiFab pu   (ba, ncomp, 0, dm);
+    MultiFab s    (ba, ncomp, 0, dm);
+    MultiFab sm   (ba, ncomp, 0, dm);
+    MultiFab z    (ba, ncomp, 0, dm);
+    MultiFab v    (ba, ncomp, 0, dm);
+    MultiFab q    (ba, ncomp, 0, dm);
+    MultiFab qu   (ba, ncomp, 0, dm);
+    MultiFab y    (ba, ncomp, 0, dm);
+
+    Lp.residual(r, rhs, sol, lev, bc_mode);
+
+    MultiFab::Copy(sorig,sol,0,0,1,0);
+    MultiFab::Copy(rh,   r,  0,0,1,0);
+
+    sol.setVal(0);
+
+    const LinOp::BC_Mode temp_bc_mode = LinOp::Homogeneous_BC;
+
+#ifdef CG_USE_OLD_CONVERGENCE_CRITERIA
+    Real rnorm = norm_inf(r);
+#else
+    Real vals[2] = { norm_inf(r, true), Lp.norm(0, lev, true) };
+
+    ParallelDescriptor::ReduceRealMax(vals,2,color());
+
+    Real       rnorm    = vals[0];
+    const Real Lp_norm  = vals[1];
+    Real       sol_norm = 0;
+#endif
+    const Real rnorm0   = rnorm;
+
+    if ( verbose > 0 && ParallelDescriptor::IOProcessor(color()) )
+    {
+        Spacer(std::cout, lev);
+        std::cout << "CGSolver_PipelinedBiCGStab: Initial error (error0) =        " << rnorm0 << '\n';
+    }
+    int ret = 0, nit = 1;
+
+    if ( rnorm0 == 0 || rnorm0 < eps_abs )
+    {
+        if ( verbose > 0 && ParallelDescriptor::IOProcessor(color()) )
+        {
+            Spacer(std::cout, lev);
+            std::cout << "CGSolver_PipelinedBiCGStab: niter = 0,"
+                      << ", rnorm = " << rnorm
+                      << ", eps_abs = " << eps_abs << std::endl;
+        }
+        return ret;
+    }
+
+    precond(u, r, eps_rel, eps_abs);
+    Lp.apply(w, u, lev, temp_bc_mode);
+
+    MultiFabReduction red0;
+
+    const int i0_rho = red0.addDot(rh,0,r,0);
+    const int i0_rw  = red0.addDot(rh,0,w,0);
+
+    red0.reduce_nowait();
+
+    precond(wm, w, eps_rel, eps_abs);
+    Lp.apply(t, wm, lev, temp_bc_mode);
+
+    red0.wait();
+
+    Real rho = red0[i0_rho], alpha = 0, omega = 0, beta = 0;
+
+    if ( Real rw = red0[i0_rw] )
+    {
+        alpha = rho/rw;
+    }
+    else
+    {
+        ret = 2;
+    }
+    //
+    // The reductions at the two synchronization points of each iteration.
+    //
+    MultiFabReduction red1, red2;
+
+    const int i1_qy = red1.addDot(q,0,y,0);
+    const int i1_yy = red1.addDot(y,0,y,0);
+
+    const int i2_rho   = red2.addDot(rh,0,r,0);
+    const int i2_rw    = red2.addDot(rh,0,w,0);
+    const int i2_rs    = red2.addDot(rh,0,s,0);
+    const int i2_rz    = red2.addDot(rh,0,z,0);
+    const int i2_rnorm = red2.addNorm0(r,0);
+#ifndef CG_USE_OLD_CONVERGENCE_CRITERIA
+    const int i2_snorm = red2.addNorm0(sol,0);
+#endif
+
+    for (; ret == 0 && nit <= maxiter; ++nit)
+    {
+        if ( nit == 1 )
+        {
+            MultiFab::Copy(p, r, 0,0,1,0);
+            MultiFab::Copy(pu,u, 0,0,1,0);
+            MultiFab::Copy(s, w, 0,0,1,0);
+            MultiFab::Copy(sm,wm,0,0,1,0);
+            MultiFab::Copy(z, t, 0,0,1,0);
+        }
+        else
+        {
+            sxay(p,  p,  -omega, s);
+            sxay(p,  r,   beta,  p);
+            sxay(pu, pu, -omega, sm);
+            sxay(pu, u,   beta,  pu);
+            sxay(s,  s,  -omega, z);
+            sxay(s,  w,   beta,  s);
+            sxay(sm, sm, -omega, zm);
+            sxay(sm, wm,  beta,  sm);
+            sxay(z,  z,  -omega, v);
+            sxay(z,  t,   beta,  z);
+        }
+        sxay(q, r, -alpha, s);
+        sxay(y, w, -alpha, z);
+
+        red1.reduce_nowait();
+
+        precond(zm, z, eps_rel, eps_abs);
+        Lp.apply(v, zm, lev, temp_bc_mode);
+
+        red1.wait();
+
+        if ( Real yy = red1[i1_yy] )
+        {
+            omega = red1[i1_qy]/yy;
+        }
+        else
+        {
+            ret = 3; break;
+        }
+        sxay(qu,  u,   -alpha, sm);
+        sxay(sol, sol,  alpha, pu);
+        sxay(sol, sol,  omega, qu);
+        sxay(r,   q,   -omega, y);
+        sxay(u,   wm,  -alpha, zm);
+        sxay(u,   qu,  -omega, u);
+        sxay(w,   t,   -alpha, v);
+        sxay(w,   y,   -omega, w);
+
+        red2.reduce_nowait();
+
+        precond(wm, w, eps_rel, eps_abs);
+        Lp.apply(t, wm, lev, temp_bc_mode);
+
+        red2.wait();
+
+        rnorm = red2[i2_rnorm];
+
+        if ( verbose > 2 && ParallelDescriptor::IOProcessor(color()) )
+        {
+            Spacer(std::cout, lev);
+            std::cout << "CGSolver_PipelinedBiCGStab: Iteration "
+                      << std::setw(11) << nit
+                      << " rel. err. "
+                      << rnorm/(rnorm0) << '\n';
+        }
+
+#ifdef CG_USE_OLD_CONVERGENCE_CRITERIA
+        if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs ) break;
+#else
+        sol_norm = red2[i2_snorm];
+        if ( rnorm < eps_rel*(Lp_norm*sol_norm + rnorm0 ) || rnorm < eps_abs ) break;
+#endif
+        if ( omega == 0 )
+        {
+            ret = 4; break;
+        }
+        const Real rho_1 = rho;
+
+        rho = red2[i2_rho];
+
+        if ( rho == 0 )
+        {
+            ret = 1; break;
+        }
+        beta = (rho/rho_1)*(alpha/omega);
+
+        if ( Real denom = red2[i2_rw] + beta*red2[i2_rs] - beta*omega*red2[i2_rz] )
+        {
+            alpha = rho/denom;
+        }
+        else
+        {
+            ret = 2; break;
+        }
+    }
+
+    if ( verbose > 0 && ParallelDescriptor::IOProcessor(color()) )
+    {
+        Spacer(std::cout, lev);
+        std::cout << "CGSolver_PipelinedBiCGStab: Final: Iteration "
+                  << std::setw(4) << nit
+                  << " rel. err. "
+                  << rnorm/(rnorm0) << '\n';
+    }
+
+#ifdef CG_USE_OLD_CONVERGENCE_CRITERIA
+    if ( ret == 0 && rnorm > eps_rel*rnorm0 && rnorm > eps_abs)
+#else
+    if ( ret == 0 && rnorm > eps_rel*(Lp_norm*sol_norm + rnorm0 ) && rnorm > eps_abs )
+#endif
+    {
+        if ( ParallelDescriptor::IOProcessor(color()) )
+            BoxLib::Warning("CGSolver_PipelinedBiCGStab:: failed to converge!");
+        ret = 8;
+    }
+
+    if ( ( ret == 0 || ret == 8 ) && (rnorm < rnorm0) )
+    {
+        sol.plus(sorig, 0, 1, 0);
+    }
+    else
+    {
+        sol.setVal(0);
+        sol.plus(sorig, 0, 1, 0);
+    }
+
+    return ret;
+}
+
 int
 CGSolver::jbb_precond (MultiFab&       sol,
 		       const MultiFab& rhs,
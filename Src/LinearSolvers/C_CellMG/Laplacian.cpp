@@ -1,5 +1,6 @@
 
 #include <winstd.H>
+#include <typeinfo>
 #include <Laplacian.H>
 #include <LP_F.H>
 
@@ -22,6 +23,22 @@ Laplacian::norm (int nm, int level, const bool local)
   return -1.0;
 }
 
+LinOp*
+Laplacian::makeAgglomerated (const BndryData& bd,
+                             int              level)
+{
+    if (typeid(*this) != typeid(Laplacian)) return 0;
+
+    prepareForLevel(level);
+
+    Laplacian* op = new Laplacian(bd, h[level][0]);
+
+    op->harmavg  = harmavg;
+    op->maxorder = maxorder;
+
+    return op;
+}
+
 void
 Laplacian::compFlux (D_DECL(MultiFab &xflux, MultiFab &yflux, MultiFab &zflux),
 		     MultiFab& in, const BC_Mode& bc_mode,
@@ -238,15 +238,26 @@ LinOp::applyBC (MultiFab&      inout,
 
     const bool cross = true;
 
-    inout.FillBoundary(src_comp,num_comp,local,cross);
+    BL_ASSERT(level < int(geomarray.size()));
+
+    if (local)
+    {
+        inout.FillBoundary(src_comp,num_comp,local,cross);
+        //
+        // Do periodic fixup.
+        //
+        geomarray[level].FillPeriodicBoundary(inout,src_comp,num_comp,false,local);
+    }
+    else
+    {
+        //
+        // The periodic ghost cells come in the same messages.
+        //
+        inout.FillBoundary(src_comp,num_comp,geomarray[level],cross);
+    }
 
     prepareForLevel(level);
     //
-    // Do periodic fixup.
-    //
-    BL_ASSERT(level<geomarray.size());
-    geomarray[level].FillPeriodicBoundary(inout,src_comp,num_comp,false,local);
-    //
     // Fill boundary cells.
     //
     // OMP over boxes
@@ -347,6 +358,16 @@ LinOp::residual (MultiFab&       residL,
     }
 }
 
+bool
+LinOp::residualRestrict (MultiFab&       crseResL,
+                         const MultiFab& rhsL,
+                         MultiFab&       solnL,
+                         int             level,
+                         LinOp::BC_Mode  bc_mode)
+{
+    return false;
+}
+
 void
 LinOp::smooth (MultiFab&       solnL,
                const MultiFab& rhsL,
@@ -714,6 +735,13 @@ LinOp::bCoefficients (int dir,int level)
     return junk;
 }
 
+LinOp*
+LinOp::makeAgglomerated (const BndryData& bd,
+                         int              level)
+{
+    return 0;
+}
+
 int
 LinOp::maxOrder (int maxorder_)
 {
@@ -2,6 +2,7 @@
 #include <winstd.H>
 #include <algorithm>
 #include <cstdlib>
+#include <limits>
 
 #include <ParmParse.H>
 #include <Utility.H>
@@ -31,6 +32,9 @@ int              MultiGrid::def_maxiter_b;
 int              MultiGrid::def_numLevelsMAX;
 int              MultiGrid::def_smooth_on_cg_unstable;
 int              MultiGrid::use_Anorm_for_convergence;
+int              MultiGrid::def_agglomerate;
+int              MultiGrid::def_agg_grid_size;
+int              MultiGrid::def_agg_nprocs;
 
 void
 MultiGrid::Initialize ()
@@ -56,6 +60,9 @@ MultiGrid::Initialize ()
     MultiGrid::def_maxiter_b             = 120;
     MultiGrid::def_numLevelsMAX          = 1024;
     MultiGrid::def_smooth_on_cg_unstable = 1;
+    MultiGrid::def_agglomerate           = 0;
+    MultiGrid::def_agg_grid_size         = 32;
+    MultiGrid::def_agg_nprocs            = 0;
 
     // This has traditionally been part of the stopping criteria, but for testing against
     //  other solvers it is convenient to be able to turn it off
@@ -77,6 +84,9 @@ MultiGrid::Initialize ()
     pp.query("maxiter_b",             def_maxiter_b);
     pp.query("numLevelsMAX",          def_numLevelsMAX);
     pp.query("smooth_on_cg_unstable", def_smooth_on_cg_unstable);
+    pp.query("agglomerate",           def_agglomerate);
+    pp.query("agg_grid_size",         def_agg_grid_size);
+    pp.query("agg_nprocs",            def_agg_nprocs);
 
     pp.query("use_Anorm_for_convergence", use_Anorm_for_convergence);
 #ifndef CG_USE_OLD_CONVERGENCE_CRITERIA
@@ -103,6 +113,9 @@ MultiGrid::Initialize ()
         std::cout << "   def_numLevelsMAX          = " << def_numLevelsMAX          << '\n';
         std::cout << "   def_smooth_on_cg_unstable = " << def_smooth_on_cg_unstable << '\n';
         std::cout << "   use_Anorm_for_convergence = " << use_Anorm_for_convergence << '\n';
+        std::cout << "   def_agglomerate           = " << def_agglomerate           << '\n';
+        std::cout << "   def_agg_grid_size         = " << def_agg_grid_size         << '\n';
+        std::cout << "   def_agg_nprocs            = " << def_agg_nprocs            << '\n';
     }
 
     BoxLib::ExecOnFinalize(MultiGrid::Finalize);
@@ -135,6 +148,11 @@ Spacer (std::ostream& os, int lev)
 
 MultiGrid::MultiGrid (LinOp &_lp)
     :
+    agg_tried(false),
+    agg_lp(0),
+    agg_mg(0),
+    agg_rhs(0),
+    agg_cor(0),
     initialsolution(0),
     Lp(_lp)
 {
@@ -153,6 +171,9 @@ MultiGrid::MultiGrid (LinOp &_lp)
     nu_b         = def_nu_b;
     numLevelsMAX = def_numLevelsMAX;
     smooth_on_cg_unstable = def_smooth_on_cg_unstable;
+    agglomerate  = def_agglomerate;
+    agg_grid_size = def_agg_grid_size;
+    agg_nprocs   = def_agg_nprocs;
     numlevels    = numLevels();
 
     do_fixed_number_of_iters = 0;
@@ -200,6 +221,11 @@ MultiGrid::~MultiGrid ()
 {
     delete initialsolution;
 
+    delete agg_mg;
+    delete agg_lp;
+    delete agg_rhs;
+    delete agg_cor;
+
     for (int i = 0; i < cor.size(); ++i)
     {
         delete res[i];
@@ -250,6 +276,17 @@ MultiGrid::solve (MultiFab&       _sol,
                   Real            _eps_rel,
                   Real            _eps_abs,
                   LinOp::BC_Mode  bc_mode)
+{
+    if ( !solveDoit(_sol, _rhs, _eps_rel, _eps_abs, bc_mode) )
+        BoxLib::Error("MultiGrid:: failed to converge!");
+}
+
+int
+MultiGrid::solveDoit (MultiFab&       _sol,
+                      const MultiFab& _rhs,
+                      Real            _eps_rel,
+                      Real            _eps_abs,
+                      LinOp::BC_Mode  bc_mode)
 {
     //
     // Prepare memory for new level, and solve the general boundary
@@ -292,13 +329,12 @@ MultiGrid::solve (MultiFab&       _sol,
     }
 
     if (tmp[1] == 0.0)
-	return;
+	return 1;
 
     //
     // We can now use homogeneous bc's because we have put the problem into residual-correction form.
     //
-    if ( !solve_(_sol, _eps_rel, _eps_abs, LinOp::Homogeneous_BC, tmp[0], tmp[1]) )
-        BoxLib::Error("MultiGrid:: failed to converge!");
+    return solve_(_sol, _eps_rel, _eps_abs, LinOp::Homogeneous_BC, tmp[0], tmp[1]);
 }
 
 int
@@ -600,17 +636,24 @@ MultiGrid::relax (MultiFab&      solL,
         {
             Lp.smooth(solL, rhsL, level, bc_mode);
         }
-        Lp.residual(*res[level], rhsL, solL, level, bc_mode);
-
-        if ( verbose > 2 )
+        prepareForLevel(level+1);
+        //
+        // Use the operator's fused residual-and-restrict if it has one,
+        // unless we want the fine residual for diagnostics.
+        //
+        if ( verbose > 2 || !Lp.residualRestrict(*rhs[level+1], rhsL, solL, level, bc_mode) )
         {
-           Real rnorm = norm_inf(*res[level]);
-           if (ParallelDescriptor::IOProcessor(color()))
-              std::cout << "    DN:Norm after  smooth " << rnorm << '\n';
-        }
+            Lp.residual(*res[level], rhsL, solL, level, bc_mode);
 
-        prepareForLevel(level+1);
-        average(*rhs[level+1], *res[level]);
+            if ( verbose > 2 )
+            {
+               Real rnorm = norm_inf(*res[level]);
+               if (ParallelDescriptor::IOProcessor(color()))
+                  std::cout << "    DN:Norm after  smooth " << rnorm << '\n';
+            }
+
+            average(*rhs[level+1], *res[level]);
+        }
         cor[level+1]->setVal(0.0);
         for (int i = cntRelax(); i > 0 ; i--)
         {
@@ -707,13 +750,22 @@ MultiGrid::coarsestSmooth (MultiFab&      solL,
     }
     else
     {
-        bool use_mg_precond = false;
-	CGSolver cg(Lp, use_mg_precond, level);
-	cg.setMaxIter(maxiter_b);
-
         const Real stime = ParallelDescriptor::second();
 
-	int ret = cg.solve(solL, rhsL, rtol_b, atol_b, bc_mode);
+        int ret;
+
+        if ( agglomerate && prepareAgglomerated(level) )
+        {
+            ret = agglomeratedSolve(solL, rhsL, bc_mode);
+        }
+        else
+        {
+            bool use_mg_precond = false;
+            CGSolver cg(Lp, use_mg_precond, level);
+            cg.setMaxIter(maxiter_b);
+
+            ret = cg.solve(solL, rhsL, rtol_b, atol_b, bc_mode);
+        }
         //
         // The whole purpose of cg_time is to accumulate time spent in CGSolver.
         //
@@ -755,6 +807,182 @@ MultiGrid::coarsestSmooth (MultiFab&      solL,
     }
 }
 
+bool
+MultiGrid::prepareAgglomerated (int level)
+{
+    if ( agg_lp != 0 ) return true;
+
+    if ( agg_tried ) return false;
+
+    agg_tried = true;
+
+    BL_PROFILE("MultiGrid::prepareAgglomerated()");
+
+    const BoxArray& ba  = Lp.boxArray(level);
+    const Box       bbx = ba.minimalBox();
+
+    if ( ba.numPts() != bbx.numPts() )
+    {
+        if ( ParallelDescriptor::IOProcessor(color()) && verbose > 0 )
+            std::cout << "MultiGrid: coarsest level isn't a box; not agglomerating\n";
+        return false;
+    }
+    //
+    // Find the boundary condition type and location on each face of bbx,
+    // and their negatives so a single max reduction gives us max and min.
+    //
+    const int  N    = 2*BL_SPACEDIM;
+    const Real rmax = std::numeric_limits<Real>::max();
+
+    Array<Real> bc(4*N, -rmax);
+
+    const BndryData& bgb = Lp.bndryData();
+
+    for (FabSetIter bfsi(bgb[Orientation(0,Orientation::low)]); bfsi.isValid(); ++bfsi)
+    {
+        const int  gn = bfsi.index();
+        const Box& bx = ba[gn];
+
+        const BndryData::RealTuple&      bdl = bgb.bndryLocs(gn);
+        const Array< Array<BoundCond> >& bdc = bgb.bndryConds(gn);
+
+        for (OrientationIter oitr; oitr; ++oitr)
+        {
+            const Orientation face = oitr();
+            const int         d    = face.coordDir();
+
+            const bool on_face = face.isLow() ? (bx.smallEnd(d) == bbx.smallEnd(d))
+                                              : (bx.bigEnd(d)   == bbx.bigEnd(d));
+            if ( on_face )
+            {
+                const Real bct = int(bdc[face][0]);
+
+                bc[    face] = std::max(bc[    face],  bct);
+                bc[  N+face] = std::max(bc[  N+face], -bct);
+                bc[2*N+face] = std::max(bc[2*N+face],  bdl[face]);
+                bc[3*N+face] = std::max(bc[3*N+face], -bdl[face]);
+            }
+        }
+    }
+
+    ParallelDescriptor::ReduceRealMax(bc.dataPtr(), bc.size(), color());
+
+    for (int i = 0; i < N; ++i)
+    {
+        if ( bc[i] != -bc[N+i] || bc[2*N+i] != -bc[3*N+i] )
+        {
+            if ( ParallelDescriptor::IOProcessor(color()) && verbose > 0 )
+                std::cout << "MultiGrid: non-uniform boundary conditions; not agglomerating\n";
+            return false;
+        }
+    }
+    BoxArray aba(bbx);
+    aba.maxSize(agg_grid_size);
+    //
+    // Put the agglomerated problem on a few processes: color 0 if there
+    // are sub-communicators, otherwise the first agg_nprocs processes.
+    //
+    ParallelDescriptor::Color clr = color();
+
+    if ( clr == ParallelDescriptor::DefaultColor() )
+    {
+        if ( ParallelDescriptor::NColors() > 1 )
+        {
+            clr = ParallelDescriptor::Color(0);
+        }
+        else
+        {
+            const int nprocs = (agg_nprocs > 0) ? agg_nprocs : aba.size();
+
+            clr = ParallelDescriptor::SubsetColor(nprocs);
+        }
+    }
+
+    BndryData bd(aba, 1, Lp.getGeom(level), clr);
+
+    for (FabSetIter bfsi(bd[Orientation(0,Orientation::low)]); bfsi.isValid(); ++bfsi)
+    {
+        const int i = bfsi.index();
+
+        for (OrientationIter oitr; oitr; ++oitr)
+        {
+            const Orientation face = oitr();
+
+            bd.setBoundCond(face, i, 0, BoundCond(int(bc[face])));
+            bd.setBoundLoc(face, i, bc[2*N+face]);
+            bd.setValue(face, i, 0);
+        }
+    }
+
+    agg_lp = Lp.makeAgglomerated(bd, level);
+
+    if ( agg_lp == 0 )
+    {
+        if ( ParallelDescriptor::IOProcessor(color()) && verbose > 0 )
+            std::cout << "MultiGrid: LinOp doesn't support agglomeration\n";
+        return false;
+    }
+
+    agg_rhs = new MultiFab(aba, 1, 0, clr);
+    agg_cor = new MultiFab(aba, 1, agg_lp->NumGrow(), clr);
+
+    if ( ParallelDescriptor::isActive(clr) )
+    {
+        agg_mg = new MultiGrid(*agg_lp);
+
+        agg_mg->setVerbose(verbose);
+        agg_mg->setMaxIter(maxiter);
+        agg_mg->setUseCG(usecg);
+        agg_mg->set_preSmooth(nu_1);
+        agg_mg->set_postSmooth(nu_2);
+        agg_mg->set_cntRelax(nu_0);
+        agg_mg->set_finalSmooth(nu_f);
+        agg_mg->set_nu_b(nu_b);
+        agg_mg->set_rtol_b(rtol_b);
+        agg_mg->set_atol_b(atol_b);
+        agg_mg->set_maxiter_b(maxiter_b);
+        agg_mg->setAgglomerate(0);
+        agg_mg->smooth_on_cg_unstable = smooth_on_cg_unstable;
+    }
+
+    if ( ParallelDescriptor::IOProcessor(color()) && verbose > 0 )
+    {
+        std::cout << "MultiGrid: agglomerated " << ba.size() << " coarsest grids into "
+                  << aba.size() << " grid(s) on " << ParallelDescriptor::NProcs(clr)
+                  << " process(es)\n";
+    }
+
+    return true;
+}
+
+int
+MultiGrid::agglomeratedSolve (MultiFab&       solL,
+                              const MultiFab& rhsL,
+                              LinOp::BC_Mode  bc_mode)
+{
+    BL_PROFILE("MultiGrid::agglomeratedSolve()");
+    //
+    // The copies in and out involve all processes of color().
+    //
+    agg_rhs->copy(rhsL);
+    agg_cor->copy(solL);
+
+    int converged = 0;
+
+    if ( agg_mg != 0 )
+        converged = agg_mg->solveDoit(*agg_cor, *agg_rhs, rtol_b, atol_b, bc_mode);
+
+    if ( agg_lp->color() != color() )
+        //
+        // Let the processes that sat out know how it went.
+        //
+        ParallelDescriptor::ReduceIntMax(converged, color());
+
+    solL.copy(*agg_cor);
+
+    return converged ? 0 : 1;
+}
+
 void
 MultiGrid::average (MultiFab&       c,
                     const MultiFab& f)
@@ -103,10 +103,18 @@ ABec4::applyBC (MultiFab&     inout,
 
     prepareForLevel(level);
 
-    const bool cross = false;
-    inout.FillBoundary(src_comp,num_comp,local,cross);
-    BL_ASSERT(level<geomarray.size());
-    geomarray[level].FillPeriodicBoundary(inout,src_comp,num_comp,true,local);
+    const bool cross   = false;
+    const bool corners = true;
+    BL_ASSERT(level < int(geomarray.size()));
+    if (local)
+    {
+        inout.FillBoundary(src_comp,num_comp,local,cross);
+        geomarray[level].FillPeriodicBoundary(inout,src_comp,num_comp,corners,local);
+    }
+    else
+    {
+        inout.FillBoundary(src_comp,num_comp,geomarray[level],cross,corners);
+    }
 
     //
     // Fill boundary cells.
@@ -637,13 +645,12 @@ ABec4::Fapply (MultiFab&       y,
     const MultiFab& a = aCoefficients(level);
     const MultiFab& b = bCoefficients(level);
 
-    const bool cross = false;
-    bool local = false;
-    const_cast<MultiFab&>(b).FillBoundary(src_comp,num_comp,local,cross);
+    const bool cross   = false;
+    const bool corners = true;
+    BL_ASSERT(level < int(geomarray.size()));
+    const_cast<MultiFab&>(b).FillBoundary(src_comp,num_comp,geomarray[level],cross,corners);
 
     prepareForLevel(level);
-    BL_ASSERT(level<geomarray.size());
-    geomarray[level].FillPeriodicBoundary(const_cast<MultiFab&>(b),src_comp,num_comp,true,local);
 
     const bool tiling = true;
 
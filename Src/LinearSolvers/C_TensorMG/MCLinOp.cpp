@@ -200,10 +200,8 @@ MCLinOp::applyBC (MultiFab& inout,
     BL_ASSERT(nc == numcomp );
 
     inout.setBndry(-1.e30);
-    inout.FillBoundary();
+    inout.FillBoundary(geomarray[level]);
     prepareForLevel(level);
-
-    geomarray[level].FillPeriodicBoundary(inout,0,nc);
     //
     // Fill boundary cells.
     //
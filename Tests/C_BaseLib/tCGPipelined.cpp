@@ -0,0 +1,194 @@
+//
+// Checks the pipelined Krylov methods of CGSolver against the classic ones
+// they stand in for: PipelinedCG against CG and PipelinedBiCGStab against
+// BiCGStab.  A variable-coefficient ABecLaplacian problem with Dirichlet
+// boundaries is solved with each method, with and without the multigrid
+// preconditioner.  Every solve must converge, its true residual must meet
+// the solver's criterion, eps_rel*(|L| |sol| + |rhs|), up to a factor of
+// ten, and each pipelined solution must agree with the classic one.
+//
+
+#include <winstd.H>
+#include <iostream>
+#include <cmath>
+
+#include <BoxLib.H>
+#include <ParmParse.H>
+#include <MultiFab.H>
+#include <Geometry.H>
+#include <BndryData.H>
+#include <LO_BCTYPES.H>
+#include <ABecLaplacian.H>
+#include <CGSolver.H>
+
+namespace
+{
+    const Real pi = 3.14159265358979323846;
+
+    void
+    set_boundary (BndryData& bd, const MultiFab& rhs, const Geometry& geom)
+    {
+        const Real* dx     = geom.CellSize();
+        const Box&  domain = geom.Domain();
+
+        for (MFIter mfi(rhs); mfi.isValid(); ++mfi)
+        {
+            const int  i  = mfi.index();
+            const Box& bx = mfi.validbox();
+
+            for (OrientationIter oitr; oitr; ++oitr)
+            {
+                const Orientation o = oitr();
+                const int         d = o.coordDir();
+
+                const bool at_domain = o.isLow() ? bx.smallEnd(d) == domain.smallEnd(d)
+                                                 : bx.bigEnd(d)   == domain.bigEnd(d);
+
+                bd.setBoundCond(o, i, 0, LO_DIRICHLET);
+                bd.setBoundLoc (o, i, at_domain ? 0.0 : 0.5*dx[d]);
+                bd.setValue    (o, i, 0.0);
+            }
+        }
+    }
+}
+
+int
+main (int argc, char* argv[])
+{
+    BoxLib::Initialize(argc,argv);
+
+    int  n_cell   = 32;
+    int  max_grid = 8;
+    int  maxiter  = 400;
+    Real eps_rel  = 1.e-10;
+
+    ParmParse pp;
+
+    pp.query("n_cell",   n_cell);
+    pp.query("max_grid", max_grid);
+    pp.query("maxiter",  maxiter);
+    pp.query("eps_rel",  eps_rel);
+
+    int nfail = 0;
+
+    {
+        const Box domain(IntVect::TheZeroVector(), IntVect(D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+
+        BoxArray ba(domain);
+        ba.maxSize(max_grid);
+
+        RealBox rb;
+        for (int d = 0; d < BL_SPACEDIM; ++d)
+        {
+            rb.setLo(d, 0.0);
+            rb.setHi(d, 1.0);
+        }
+
+        const Geometry geom(domain, &rb, 0);
+        const Real*    dx = geom.CellSize();
+
+        MultiFab rhs(ba, 1, 0), alpha(ba, 1, 0), res(ba, 1, 0);
+
+        PArray<MultiFab> beta(BL_SPACEDIM, PArrayManage);
+
+        for (int d = 0; d < BL_SPACEDIM; ++d)
+        {
+            BoxArray eba(ba);
+            eba.surroundingNodes(d);
+            beta.set(d, new MultiFab(eba, 1, 0));
+        }
+
+        alpha.setVal(1.0);
+
+        for (MFIter mfi(rhs); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+            {
+                rhs[mfi](iv) = D_TERM(  std::sin(  pi*(iv[0]+0.5)*dx[0]),
+                                      * std::sin(2*pi*(iv[1]+0.5)*dx[1]),
+                                      * std::sin(  pi*(iv[2]+0.5)*dx[2]));
+            }
+
+            for (int d = 0; d < BL_SPACEDIM; ++d)
+            {
+                const Box& eb = beta[d][mfi].box();
+
+                for (IntVect iv = eb.smallEnd(); iv <= eb.bigEnd(); eb.next(iv))
+                    beta[d][mfi](iv) = 1.0 + 0.5*std::sin(0.3*iv[0] + 0.2*iv[1]);
+            }
+        }
+
+        BndryData bd(ba, 1, geom);
+
+        set_boundary(bd, rhs, geom);
+
+        ABecLaplacian op(bd, dx);
+
+        op.setScalars(0.01, 1.0);
+        op.setCoefficients(alpha, beta);
+
+        const Real rhs_norm = rhs.norm0();
+        const Real op_norm  = op.norm(0, 0);
+
+        const CGSolver::Solver classic[]   = { CGSolver::CG,          CGSolver::BiCGStab          };
+        const CGSolver::Solver pipelined[] = { CGSolver::PipelinedCG, CGSolver::PipelinedBiCGStab };
+        const char*            names[]     = { "CG",                  "BiCGStab"                  };
+
+        for (int use_mg = 0; use_mg < 2; ++use_mg)
+        {
+            for (int k = 0; k < 2; ++k)
+            {
+                MultiFab sol[2];
+
+                bool ok = true;
+
+                for (int p = 0; p < 2; ++p)
+                {
+                    sol[p].define(ba, 1, 1, Fab_allocate);
+                    sol[p].setVal(0.0);
+
+                    CGSolver cg(op, use_mg);
+
+                    cg.setSolver(p == 0 ? classic[k] : pipelined[k]);
+                    cg.setMaxIter(maxiter);
+
+                    const int ret = cg.solve(sol[p], rhs, eps_rel, 0.0);
+
+                    op.residual(res, rhs, sol[p], 0, LinOp::Inhomogeneous_BC);
+
+                    const Real res_norm = res.norm0();
+                    const Real tol      = 10*eps_rel*(op_norm*sol[p].norm0() + rhs_norm);
+
+                    if (ParallelDescriptor::IOProcessor())
+                        std::cout << (p == 0 ? "" : "Pipelined") << names[k]
+                                  << (use_mg ? " with MG" : "")
+                                  << ": return " << ret
+                                  << ", residual " << res_norm
+                                  << " (tolerance " << tol << ")\n";
+
+                    if (ret != 0 || res_norm > tol) ok = false;
+                }
+
+                MultiFab::Subtract(sol[1], sol[0], 0, 0, 1, 0);
+
+                const Real diff = sol[1].norm0() / sol[0].norm0();
+
+                if (ParallelDescriptor::IOProcessor())
+                    std::cout << "    solutions differ by " << diff << '\n';
+
+                if (diff > 1.e-6) ok = false;
+
+                if (!ok) ++nfail;
+            }
+        }
+    }
+
+    if (ParallelDescriptor::IOProcessor())
+        std::cout << (nfail == 0 ? "PASSED" : "FAILED") << std::endl;
+
+    BoxLib::Finalize();
+
+    return nfail == 0 ? 0 : 1;
+}
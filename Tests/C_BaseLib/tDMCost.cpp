@@ -0,0 +1,113 @@
+//
+// Checks the cost-weighted DistributionMapping::define() used by Amr's
+// measured-cost load balancing (amr.use_measured_cost = 1).  The cost of
+// a box grows with its distance from the low x face, up to ten times what
+// its cell count says.  For the KNAPSACK and SFC strategies the maximum
+// load of the weighted map must be within one box of the average load,
+// the weighted map must replace the cached cell-count map of the same
+// BoxArray, and the map handed out before must be left alone.  KNAPSACK
+// must also do no worse than the cell-count map.  SFC keeps each CPU's
+// boxes contiguous along the curve, so it isn't held to that.
+//
+// Run with more than one MPI process.
+//
+
+#include <winstd.H>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+#include <BoxLib.H>
+#include <ParmParse.H>
+#include <BoxArray.H>
+#include <DistributionMapping.H>
+
+namespace
+{
+    long
+    max_load (const DistributionMapping& dm, const std::vector<long>& wgts, int nprocs)
+    {
+        std::vector<long> load(nprocs,0);
+        for (int i = 0, N = wgts.size(); i < N; ++i)
+            load[dm[i]] += wgts[i];
+        return *std::max_element(load.begin(), load.end());
+    }
+}
+
+int
+main (int argc, char* argv[])
+{
+    BoxLib::Initialize(argc,argv);
+
+    int n_cell   = 64;
+    int max_grid = 16;
+
+    ParmParse pp;
+
+    pp.query("n_cell",   n_cell);
+    pp.query("max_grid", max_grid);
+
+    const Box domain(IntVect::TheZeroVector(), IntVect(D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+
+    BoxArray ba(domain);
+    ba.maxSize(max_grid);
+
+    const int nprocs = ParallelDescriptor::NProcs();
+
+    std::vector<long> wgts(ba.size());
+    for (int i = 0; i < ba.size(); ++i)
+        wgts[i] = ba[i].numPts() * (1 + 9 * ba[i].smallEnd(0) / n_cell);
+
+    long total = 0, biggest = 0;
+    for (int i = 0; i < ba.size(); ++i)
+    {
+        total  += wgts[i];
+        biggest = std::max(biggest, wgts[i]);
+    }
+    const long bound = total / nprocs + biggest;
+
+    const DistributionMapping::Strategy strategies[] = { DistributionMapping::KNAPSACK,
+                                                         DistributionMapping::SFC };
+    const char* names[] = { "KNAPSACK", "SFC" };
+
+    bool ok = true;
+
+    for (int s = 0; s < 2; ++s)
+    {
+        DistributionMapping::strategy(strategies[s]);
+
+        DistributionMapping plain(ba, nprocs);
+
+        const Array<int> plain_map = plain.ProcessorMap();
+
+        DistributionMapping weighted;
+        weighted.define(ba, wgts, nprocs);
+
+        DistributionMapping again(ba, nprocs);
+
+        const long plain_load    = max_load(plain, wgts, nprocs);
+        const long weighted_load = max_load(weighted, wgts, nprocs);
+
+        const bool s_ok = weighted_load <= bound &&
+                          (strategies[s] != DistributionMapping::KNAPSACK || weighted_load <= plain_load) &&
+                          again == weighted &&
+                          plain.ProcessorMap() == plain_map;
+
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << names[s] << ": max load " << plain_load << " by cells, "
+                      << weighted_load << " by cost"
+                      << (again == weighted ? "" : ", weighted map not cached")
+                      << (s_ok ? "" : "  FAILED") << '\n';
+
+        ok = ok && s_ok;
+
+        DistributionMapping::FlushCache();
+    }
+
+    if (ParallelDescriptor::IOProcessor())
+        std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    BoxLib::Finalize();
+
+    return ok ? 0 : 1;
+}
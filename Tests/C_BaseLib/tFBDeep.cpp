@@ -0,0 +1,192 @@
+//
+// Checks the deep-halo support: FabArray::FillBoundary_ng() and
+// MFIter::growntilebox(ng,width,stage).
+//
+// FillBoundary_ng(nghost) must fill the first nghost ghost layers exactly
+// as FillBoundary() does and leave the layers beyond them alone.
+//
+// A stencil of width one is applied n_grow times, once after filling all
+// n_grow ghost layers, updating growntilebox(n_grow,1,stage) in stage
+// stage, and once with a FillBoundary() before every stage.  The valid
+// cells must come out the same.
+//
+
+#include <winstd.H>
+#include <iostream>
+
+#include <BoxLib.H>
+#include <ParmParse.H>
+#include <MultiFab.H>
+
+namespace
+{
+    const Real unset = -1.0;
+
+    Real
+    value (const IntVect& iv)
+    {
+        return D_TERM(iv[0], + 0.5*iv[1]*iv[1], + 0.25*iv[2]);
+    }
+
+    void
+    set_values (MultiFab& mf, const Box& domain)
+    {
+        mf.setVal(unset);
+
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        {
+            FArrayBox& fab = mf[mfi];
+            const Box& bx  = mfi.validbox();
+
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+                fab(iv) = value(iv);
+            //
+            // The stencil reads the ghost cells outside the domain; both
+            // ways of applying it leave them at zero.
+            //
+            const BoxList outside = BoxLib::boxDiff(fab.box(), domain);
+
+            for (BoxList::const_iterator it = outside.begin(); it != outside.end(); ++it)
+                fab.setVal(0.0, *it, 0, 1);
+        }
+    }
+    //
+    // One stage of the stencil on the given region of each box.
+    //
+    void
+    stage (MultiFab& u, MultiFab& tmp, const Box& domain, int ng, int st)
+    {
+        for (MFIter mfi(u,true); mfi.isValid(); ++mfi)
+        {
+            const Box bx = (ng > 0 ? mfi.growntilebox(ng,1,st) : mfi.tilebox()) & domain;
+
+            const FArrayBox& uf = u[mfi];
+            FArrayBox&       tf = tmp[mfi];
+
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+            {
+                Real r = 2*BL_SPACEDIM*uf(iv);
+
+                for (int d = 0; d < BL_SPACEDIM; ++d)
+                {
+                    const IntVect e = BoxLib::BASISV(d);
+
+                    r += uf(iv+e) + uf(iv-e);
+                }
+
+                tf(iv) = r / (4*BL_SPACEDIM);
+            }
+        }
+
+        for (MFIter mfi(u,true); mfi.isValid(); ++mfi)
+        {
+            const Box bx = (ng > 0 ? mfi.growntilebox(ng,1,st) : mfi.tilebox()) & domain;
+
+            u[mfi].copy(tmp[mfi], bx);
+        }
+    }
+}
+
+int
+main (int argc, char* argv[])
+{
+    BoxLib::Initialize(argc,argv);
+
+    int n_cell   = 32;
+    int max_grid = 8;
+    int n_grow   = 4;
+
+    ParmParse pp;
+
+    pp.query("n_cell",   n_cell);
+    pp.query("max_grid", max_grid);
+    pp.query("n_grow",   n_grow);
+
+    const Box domain(IntVect::TheZeroVector(), IntVect(D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+
+    BoxArray ba(domain);
+    ba.maxSize(max_grid);
+
+    int nfail = 0;
+    //
+    // FillBoundary_ng() against FillBoundary().
+    //
+    MultiFab full(ba, 1, n_grow), part(ba, 1, n_grow);
+
+    for (int nghost = 1; nghost <= n_grow; ++nghost)
+    {
+        set_values(full, domain);
+        set_values(part, domain);
+
+        full.FillBoundary();
+        part.FillBoundary_ng(nghost);
+
+        long nbad = 0;
+
+        for (MFIter mfi(part); mfi.isValid(); ++mfi)
+        {
+            const FArrayBox& pf = part[mfi];
+            const FArrayBox& ff = full[mfi];
+            const Box        gb = BoxLib::grow(mfi.validbox(), nghost);
+            const Box&       bx = pf.box();
+
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+            {
+                const Real expected = (gb.contains(iv) || !domain.contains(iv)) ? ff(iv) : unset;
+
+                if (pf(iv) != expected) ++nbad;
+            }
+        }
+
+        ParallelDescriptor::ReduceLongSum(nbad);
+
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "FillBoundary_ng(" << nghost << "): " << nbad << " bad values\n";
+
+        if (nbad > 0) ++nfail;
+    }
+    //
+    // n_grow stages after one exchange against an exchange every stage.
+    //
+    MultiFab u(ba, 1, n_grow), tmp(ba, 1, n_grow);
+    MultiFab uref(ba, 1, 1),   tref(ba, 1, 1);
+
+    set_values(u,    domain);
+    set_values(uref, domain);
+
+    u.FillBoundary_ng(n_grow);
+
+    for (int st = 0; st < n_grow; ++st)
+    {
+        stage(u, tmp, domain, n_grow, st);
+
+        uref.FillBoundary();
+
+        stage(uref, tref, domain, 0, st);
+    }
+
+    long ndiff = 0;
+
+    for (MFIter mfi(u); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+            if (u[mfi](iv) != uref[mfi](iv))
+                ++ndiff;
+    }
+
+    ParallelDescriptor::ReduceLongSum(ndiff);
+
+    if (ParallelDescriptor::IOProcessor())
+        std::cout << n_grow << " stages after one exchange: " << ndiff << " values differ\n";
+
+    if (ndiff > 0) ++nfail;
+
+    if (ParallelDescriptor::IOProcessor())
+        std::cout << (nfail == 0 ? "PASSED" : "FAILED") << std::endl;
+
+    BoxLib::Finalize();
+
+    return nfail == 0 ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+//
+// Checks the batched MultiFab::FillBoundary(const Array<MultiFab*>&),
+// which fills the ghost cells of several MultiFabs with one message per
+// neighbor process.  Three MultiFabs with different numbers of components
+// on the same BoxArray and DistributionMapping are filled at once, with
+// and without cross, and must end up exactly as when each is filled on
+// its own, ghost cells included.
+//
+
+#include <winstd.H>
+#include <iostream>
+
+#include <BoxLib.H>
+#include <ParmParse.H>
+#include <MultiFab.H>
+
+namespace
+{
+    const int nmf = 3;
+
+    Real
+    value (const IntVect& iv, int n, int k)
+    {
+        return D_TERM(iv[0], + 100*iv[1], + 10000*iv[2]) + 0.25*n + 1000000*k;
+    }
+
+    void
+    set_values (MultiFab& mf, int k)
+    {
+        mf.setVal(-1.0);
+
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        {
+            FArrayBox& fab = mf[mfi];
+            const Box& bx  = mfi.validbox();
+
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+                for (int n = 0; n < mf.nComp(); ++n)
+                    fab(iv,n) = value(iv,n,k);
+        }
+    }
+    //
+    // Number of values, ghost cells included, where a and b differ.
+    //
+    long
+    count_diff (const MultiFab& a, const MultiFab& b)
+    {
+        long ndiff = 0;
+
+        for (MFIter mfi(a); mfi.isValid(); ++mfi)
+        {
+            const FArrayBox& fa = a[mfi];
+            const FArrayBox& fb = b[mfi];
+            const Box&       bx = fa.box();
+
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+                for (int n = 0; n < a.nComp(); ++n)
+                    if (fa(iv,n) != fb(iv,n))
+                        ++ndiff;
+        }
+
+        ParallelDescriptor::ReduceLongSum(ndiff);
+
+        return ndiff;
+    }
+}
+
+int
+main (int argc, char* argv[])
+{
+    BoxLib::Initialize(argc,argv);
+
+    int n_cell   = 32;
+    int max_grid = 8;
+    int n_grow   = 2;
+
+    ParmParse pp;
+
+    pp.query("n_cell",   n_cell);
+    pp.query("max_grid", max_grid);
+    pp.query("n_grow",   n_grow);
+
+    const Box domain(IntVect::TheZeroVector(), IntVect(D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+
+    BoxArray ba(domain);
+    ba.maxSize(max_grid);
+
+    PArray<MultiFab> mfs(nmf, PArrayManage), refs(nmf, PArrayManage);
+
+    Array<MultiFab*> pmfs(nmf);
+
+    for (int k = 0; k < nmf; ++k)
+    {
+        mfs.set (k, new MultiFab(ba, k+1, n_grow));
+        refs.set(k, new MultiFab(ba, k+1, n_grow));
+
+        pmfs[k] = &mfs[k];
+    }
+
+    int nfail = 0;
+
+    for (int cross = 0; cross < 2; ++cross)
+    {
+        for (int k = 0; k < nmf; ++k)
+        {
+            set_values(mfs[k],  k);
+            set_values(refs[k], k);
+
+            refs[k].FillBoundary(0, refs[k].nComp(), false, bool(cross));
+        }
+
+        MultiFab::FillBoundary(pmfs, bool(cross));
+
+        for (int k = 0; k < nmf; ++k)
+        {
+            const long ndiff = count_diff(mfs[k], refs[k]);
+
+            if (ParallelDescriptor::IOProcessor())
+                std::cout << "cross = " << cross << ", MultiFab " << k << " ("
+                          << mfs[k].nComp() << " components): "
+                          << ndiff << " values differ\n";
+
+            if (ndiff > 0) ++nfail;
+        }
+    }
+
+    if (ParallelDescriptor::IOProcessor())
+        std::cout << (nfail == 0 ? "PASSED" : "FAILED") << std::endl;
+
+    BoxLib::Finalize();
+
+    return nfail == 0 ? 0 : 1;
+}
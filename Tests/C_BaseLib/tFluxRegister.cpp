@@ -0,0 +1,167 @@
+//
+// Checks that a FluxRegister doesn't reflux with the tags of grids it no
+// longer has.  One register is defined on a set of fine grids, filled and
+// refluxed twice, then cleared and defined on other fine grids with the
+// same number of boxes, and so the same processor map, filled and
+// refluxed again.  Each reflux must give exactly what a new register on
+// the same grids gives.
+//
+
+#include <winstd.H>
+#include <iostream>
+
+#include <BoxLib.H>
+#include <ParmParse.H>
+#include <MultiFab.H>
+#include <Geometry.H>
+#include <FluxRegister.H>
+
+namespace
+{
+    const int ratio = 2;
+
+    void
+    fill (FluxRegister& fr)
+    {
+        for (OrientationIter oitr; oitr; ++oitr)
+        {
+            const Orientation face = oitr();
+
+            for (FabSetIter fsi(fr[face]); fsi.isValid(); ++fsi)
+            {
+                FArrayBox& fab = fr[face][fsi];
+                const Box& bx  = fab.box();
+
+                for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+                    fab(iv) = D_TERM(iv[0], + 100*iv[1], + 10000*iv[2]) + 0.5*int(face);
+            }
+        }
+    }
+    //
+    // Reflux from fr into a zeroed mf.
+    //
+    void
+    reflux (FluxRegister& fr, MultiFab& mf, const Geometry& geom)
+    {
+        mf.setVal(0.0);
+
+        fr.Reflux(mf, 1.0, 0, 0, 1, geom);
+    }
+    //
+    // Number of values where a and b differ.
+    //
+    long
+    count_diff (const MultiFab& a, const MultiFab& b)
+    {
+        long ndiff = 0;
+
+        for (MFIter mfi(a); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+                if (a[mfi](iv) != b[mfi](iv))
+                    ++ndiff;
+        }
+
+        ParallelDescriptor::ReduceLongSum(ndiff);
+
+        return ndiff;
+    }
+    //
+    // Fine grids: the refinement of a cube of coarse cells starting at lo,
+    // chopped to max_grid.
+    //
+    BoxArray
+    fine_grids (int lo, int size, int max_grid)
+    {
+        const IntVect lov(D_DECL(lo,lo,lo));
+        const IntVect hiv(D_DECL(lo+size-1,lo+size-1,lo+size-1));
+
+        BoxArray ba(BoxLib::refine(Box(lov,hiv), ratio));
+        ba.maxSize(max_grid);
+
+        return ba;
+    }
+}
+
+int
+main (int argc, char* argv[])
+{
+    BoxLib::Initialize(argc,argv);
+
+    int n_cell   = 32;
+    int max_grid = 8;
+
+    ParmParse pp;
+
+    pp.query("n_cell",   n_cell);
+    pp.query("max_grid", max_grid);
+
+    int nfail = 0;
+
+    {
+        const Box domain(IntVect::TheZeroVector(), IntVect(D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+
+        RealBox rb;
+        int     is_per[BL_SPACEDIM];
+
+        for (int d = 0; d < BL_SPACEDIM; ++d)
+        {
+            rb.setLo(d, 0.0);
+            rb.setHi(d, 1.0);
+            is_per[d] = 1;
+        }
+
+        const Geometry geom(domain, &rb, 0, is_per);
+
+        BoxArray ba(domain);
+        ba.maxSize(max_grid);
+
+        MultiFab mf(ba, 1, 0), ref(ba, 1, 0);
+        //
+        // Two sets of fine grids with the same number of boxes; the second
+        // touches the periodic boundary.
+        //
+        const BoxArray fba[2] = { fine_grids(n_cell/4, n_cell/2, max_grid),
+                                  fine_grids(n_cell/2, n_cell/2, max_grid) };
+
+        const IntVect rr(D_DECL(ratio,ratio,ratio));
+
+        FluxRegister fr;
+
+        for (int g = 0; g < 2; ++g)
+        {
+            if (g > 0) fr.clear();
+
+            fr.define(fba[g], rr, 1, 1);
+
+            FluxRegister fresh(fba[g], rr, 1, 1);
+
+            fill(fr);
+            fill(fresh);
+
+            reflux(fresh, ref, geom);
+
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                reflux(fr, mf, geom);
+
+                const long ndiff = count_diff(mf, ref);
+
+                if (ParallelDescriptor::IOProcessor())
+                    std::cout << "fine grids " << g << ", reflux " << pass << ": "
+                              << ndiff << " values differ\n";
+
+                if (ndiff > 0) ++nfail;
+            }
+        }
+    }
+
+    if (ParallelDescriptor::IOProcessor())
+        std::cout << (nfail == 0 ? "PASSED" : "FAILED") << std::endl;
+
+    BoxLib::Finalize();
+
+    return nfail == 0 ? 0 : 1;
+}
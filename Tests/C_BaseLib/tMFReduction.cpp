@@ -0,0 +1,153 @@
+//
+// Checks MultiFabReduction against the separate MultiFab reductions it
+// replaces: sum(), min(), max(), norm0(), norm1(), norm2() and a dot
+// product, with and without ghost cells, through reduce() and
+// reduce_nowait()/wait().  Many quantities are reduced at once so that
+// MPI may split the reduction into several pieces.
+//
+// Run on several CPUs.
+//
+
+#include <winstd.H>
+#include <iostream>
+#include <cmath>
+
+#include <BoxLib.H>
+#include <ParmParse.H>
+#include <MultiFab.H>
+
+namespace
+{
+    const int ncomp = 4;
+
+    void
+    set_values (MultiFab& mf, Real shift)
+    {
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        {
+            FArrayBox& fab = mf[mfi];
+            const Box& bx  = fab.box();
+
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+                for (int n = 0; n < ncomp; ++n)
+                    fab(iv,n) = std::sin(D_TERM(0.1*iv[0], + 0.2*iv[1], + 0.3*iv[2]) + n + shift)
+                        - 0.25*mfi.index();
+        }
+    }
+
+    Real
+    dot (const MultiFab& x, int xcomp, const MultiFab& y, int ycomp)
+    {
+        MultiFab xy(x.boxArray(), 1, 0);
+
+        MultiFab::Copy(xy, x, xcomp, 0, 1, 0);
+        MultiFab::Multiply(xy, y, ycomp, 0, 1, 0);
+
+        return xy.sum(0);
+    }
+
+    bool
+    close (Real a, Real b)
+    {
+        return std::abs(a - b) <= 1.e-12 * std::max(Real(1), std::max(std::abs(a), std::abs(b)));
+    }
+
+    int
+    check (MultiFabReduction& red, const MultiFab& x, const MultiFab& y, bool nowait)
+    {
+        const int ng = x.nGrow();
+
+        std::vector<int> isum, imin, imax, in0, in1, in2, idot, in0g, imaxg;
+        //
+        // Repeat the quantities a few times to get a long reduction.
+        //
+        const int nrep = 50;
+
+        for (int r = 0; r < nrep; ++r)
+        {
+            for (int n = 0; n < ncomp; ++n)
+            {
+                isum.push_back(red.addSum(x, n));
+                imin.push_back(red.addMin(x, n));
+                imax.push_back(red.addMax(x, n));
+                in0.push_back(red.addNorm0(x, n));
+                in1.push_back(red.addNorm1(x, n));
+                in2.push_back(red.addNorm2(x, n));
+                idot.push_back(red.addDot(x, n, y, ncomp-1-n));
+                in0g.push_back(red.addNorm0(x, n, ng));
+                imaxg.push_back(red.addMax(x, n, ng));
+            }
+        }
+
+        if (nowait)
+        {
+            red.reduce_nowait();
+            red.wait();
+        }
+        else
+        {
+            red.reduce();
+        }
+
+        int nbad = 0;
+
+        for (int i = 0; i < int(isum.size()); ++i)
+        {
+            const int n = i % ncomp;
+
+            if (!close(red[isum[i]],  x.sum(n)))                  ++nbad;
+            if (!close(red[imin[i]],  x.min(n)))                  ++nbad;
+            if (!close(red[imax[i]],  x.max(n)))                  ++nbad;
+            if (!close(red[in0[i]],   x.norm0(n)))                ++nbad;
+            if (!close(red[in1[i]],   x.norm1(n)))                ++nbad;
+            if (!close(red[in2[i]],   x.norm2(n)))                ++nbad;
+            if (!close(red[idot[i]],  dot(x, n, y, ncomp-1-n)))   ++nbad;
+            if (!close(red[in0g[i]],  x.norm0(n, ng)))            ++nbad;
+            if (!close(red[imaxg[i]], x.max(n, ng)))              ++nbad;
+        }
+
+        return nbad;
+    }
+}
+
+int
+main (int argc, char* argv[])
+{
+    BoxLib::Initialize(argc,argv);
+
+    int nfail = 0;
+    {
+        Box domain(IntVect::TheZeroVector(), IntVect(D_DECL(31,31,31)));
+
+        BoxArray ba(domain);
+
+        ba.maxSize(8);
+
+        MultiFab x(ba, ncomp, 2), y(ba, ncomp, 2);
+
+        set_values(x, 0);
+        set_values(y, 1);
+
+        MultiFabReduction red;
+
+        for (int nowait = 0; nowait < 2; ++nowait)
+        {
+            red.clear();
+
+            const int nbad = check(red, x, y, nowait);
+
+            if (ParallelDescriptor::IOProcessor())
+                std::cout << (nowait ? "reduce_nowait(): " : "reduce(): ")
+                          << nbad << " bad values out of " << red.size() << '\n';
+
+            if (nbad > 0) ++nfail;
+        }
+
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << (nfail == 0 ? "PASSED" : "FAILED") << std::endl;
+    }
+
+    BoxLib::Finalize();
+
+    return nfail;
+}
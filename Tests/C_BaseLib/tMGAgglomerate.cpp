@@ -0,0 +1,262 @@
+//
+// Checks the agglomerated bottom solve of MultiGrid (mg.agglomerate = 1).
+// A variable-coefficient ABecLaplacian problem with Dirichlet boundaries,
+// whose coarsest multigrid level has many small grids, is solved without
+// agglomeration, with the bottom problem on one process per agglomerated
+// grid and with it on two processes, more than there are agglomerated
+// grids by default.  Every solve must meet the solver's criterion,
+// eps_rel*(|L| |sol| + |rhs|), up to a factor of ten, and the solutions
+// must agree.
+//
+// Also checks what the agglomeration relies on: a class derived from
+// ABecLaplacian must not be agglomerated as a plain ABecLaplacian, and
+// each distribution strategy must keep a map made for a subset of the
+// processes (ParallelDescriptor::SubsetColor()) on those processes.
+//
+
+#include <winstd.H>
+#include <algorithm>
+#include <iostream>
+#include <cmath>
+
+#include <BoxLib.H>
+#include <ParmParse.H>
+#include <MultiFab.H>
+#include <Geometry.H>
+#include <BndryData.H>
+#include <LO_BCTYPES.H>
+#include <ABecLaplacian.H>
+#include <MultiGrid.H>
+
+namespace
+{
+    const Real pi = 3.14159265358979323846;
+
+    class DerivedABec
+        : public ABecLaplacian
+    {
+    public:
+        DerivedABec (const BndryData& bd, const Real* h) : ABecLaplacian(bd,h) {}
+    };
+
+    void
+    set_boundary (BndryData& bd, const MultiFab& rhs, const Geometry& geom)
+    {
+        const Real* dx     = geom.CellSize();
+        const Box&  domain = geom.Domain();
+
+        for (MFIter mfi(rhs); mfi.isValid(); ++mfi)
+        {
+            const int  i  = mfi.index();
+            const Box& bx = mfi.validbox();
+
+            for (OrientationIter oitr; oitr; ++oitr)
+            {
+                const Orientation o = oitr();
+                const int         d = o.coordDir();
+
+                const bool at_domain = o.isLow() ? bx.smallEnd(d) == domain.smallEnd(d)
+                                                 : bx.bigEnd(d)   == domain.bigEnd(d);
+
+                bd.setBoundCond(o, i, 0, LO_DIRICHLET);
+                bd.setBoundLoc (o, i, at_domain ? 0.0 : 0.5*dx[d]);
+                bd.setValue    (o, i, 0.0);
+            }
+        }
+    }
+}
+
+int
+main (int argc, char* argv[])
+{
+    BoxLib::Initialize(argc,argv);
+
+    int  n_cell   = 64;
+    int  max_grid = 8;
+    Real eps_rel  = 1.e-10;
+
+    ParmParse pp;
+
+    pp.query("n_cell",   n_cell);
+    pp.query("max_grid", max_grid);
+    pp.query("eps_rel",  eps_rel);
+
+    int nfail = 0;
+
+    {
+        const Box domain(IntVect::TheZeroVector(), IntVect(D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+
+        BoxArray ba(domain);
+        ba.maxSize(max_grid);
+
+        RealBox rb;
+        for (int d = 0; d < BL_SPACEDIM; ++d)
+        {
+            rb.setLo(d, 0.0);
+            rb.setHi(d, 1.0);
+        }
+
+        const Geometry geom(domain, &rb, 0);
+        const Real*    dx = geom.CellSize();
+
+        MultiFab rhs(ba, 1, 0), alpha(ba, 1, 0), res(ba, 1, 0);
+
+        PArray<MultiFab> beta(BL_SPACEDIM, PArrayManage);
+
+        for (int d = 0; d < BL_SPACEDIM; ++d)
+        {
+            BoxArray eba(ba);
+            eba.surroundingNodes(d);
+            beta.set(d, new MultiFab(eba, 1, 0));
+        }
+
+        alpha.setVal(1.0);
+
+        for (MFIter mfi(rhs); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+            {
+                rhs[mfi](iv) = D_TERM(  std::sin(  pi*(iv[0]+0.5)*dx[0]),
+                                      * std::sin(2*pi*(iv[1]+0.5)*dx[1]),
+                                      * std::sin(  pi*(iv[2]+0.5)*dx[2]));
+            }
+
+            for (int d = 0; d < BL_SPACEDIM; ++d)
+            {
+                const Box& eb = beta[d][mfi].box();
+
+                for (IntVect iv = eb.smallEnd(); iv <= eb.bigEnd(); eb.next(iv))
+                    beta[d][mfi](iv) = 1.0 + 0.5*std::sin(0.3*iv[0] + 0.2*iv[1]);
+            }
+        }
+
+        BndryData bd(ba, 1, geom);
+
+        set_boundary(bd, rhs, geom);
+        //
+        // The solves.  agg_nprocs = 0 means one process per agglomerated grid.
+        //
+        const int agglomerate[] = { 0, 1, 1 };
+        const int agg_nprocs[]  = { 0, 0, 2 };
+        const int nsolves       = sizeof(agglomerate) / sizeof(agglomerate[0]);
+
+        MultiFab sol[nsolves];
+
+        for (int k = 0; k < nsolves; ++k)
+        {
+            ABecLaplacian op(bd, dx);
+
+            op.setScalars(0.01, 1.0);
+            op.setCoefficients(alpha, beta);
+
+            sol[k].define(ba, 1, 1, Fab_allocate);
+            sol[k].setVal(0.0);
+
+            MultiGrid mg(op);
+
+            mg.setAgglomerate(agglomerate[k]);
+            mg.setAggNProcs(agg_nprocs[k]);
+
+            mg.solve(sol[k], rhs, eps_rel, 0.0);
+
+            op.residual(res, rhs, sol[k], 0, LinOp::Inhomogeneous_BC);
+
+            const Real res_norm = res.norm0();
+            const Real tol      = 10*eps_rel*(op.norm(0, 0)*sol[k].norm0() + rhs.norm0());
+
+            bool ok = res_norm <= tol;
+
+            Real diff = 0;
+
+            if (k > 0)
+            {
+                MultiFab::Copy    (res, sol[k], 0, 0, 1, 0);
+                MultiFab::Subtract(res, sol[0], 0, 0, 1, 0);
+
+                diff = res.norm0() / sol[0].norm0();
+
+                if (diff > 1.e-7) ok = false;
+            }
+
+            if (ParallelDescriptor::IOProcessor())
+            {
+                std::cout << "agglomerate = " << agglomerate[k];
+                if (agglomerate[k])
+                    std::cout << ", agg_nprocs = " << agg_nprocs[k];
+                std::cout << ": residual " << res_norm << " (tolerance " << tol << ")";
+                if (k > 0)
+                    std::cout << ", differs by " << diff;
+                std::cout << '\n';
+            }
+
+            if (!ok) ++nfail;
+        }
+        //
+        // A derived operator must be left to the plain bottom solve.
+        //
+        {
+            DerivedABec dop(bd, dx);
+
+            dop.setScalars(0.01, 1.0);
+            dop.setCoefficients(alpha, beta);
+
+            LinOp* agg = dop.makeAgglomerated(bd, 0);
+
+            if (ParallelDescriptor::IOProcessor())
+                std::cout << "derived ABecLaplacian: "
+                          << (agg == 0 ? "not agglomerated" : "agglomerated") << '\n';
+
+            if (agg != 0) ++nfail;
+
+            delete agg;
+        }
+        //
+        // Maps made for the first nsub processes stay on them.
+        //
+        const int nsub = std::max(1, ParallelDescriptor::NProcs()/2);
+
+        const ParallelDescriptor::Color clr = ParallelDescriptor::SubsetColor(nsub);
+
+        const DistributionMapping::Strategy strategies[] = { DistributionMapping::ROUNDROBIN,
+                                                             DistributionMapping::KNAPSACK,
+                                                             DistributionMapping::SFC,
+                                                             DistributionMapping::RRSFC };
+        const char* snames[] = { "ROUNDROBIN", "KNAPSACK", "SFC", "RRSFC" };
+
+        const DistributionMapping::Strategy old_strategy = DistributionMapping::strategy();
+
+        for (int s = 0; s < 4; ++s)
+        {
+            DistributionMapping::strategy(strategies[s]);
+            //
+            // Or we'd get the cached map of the previous strategy.
+            //
+            DistributionMapping::FlushCache();
+
+            const DistributionMapping dm(ba, nsub, clr);
+
+            int nbad = 0;
+
+            for (int i = 0; i < ba.size(); ++i)
+                if (dm[i] < 0 || dm[i] >= nsub)
+                    ++nbad;
+
+            if (ParallelDescriptor::IOProcessor())
+                std::cout << snames[s] << " on " << nsub << " process(es): "
+                          << nbad << " boxes elsewhere\n";
+
+            if (nbad > 0) ++nfail;
+        }
+
+        DistributionMapping::strategy(old_strategy);
+    }
+
+    if (ParallelDescriptor::IOProcessor())
+        std::cout << (nfail == 0 ? "PASSED" : "FAILED") << std::endl;
+
+    BoxLib::Finalize();
+
+    return nfail == 0 ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+//
+// Checks ParticleContainer::Redistribute() on a periodic two-level
+// hierarchy whose fine level covers the middle of the domain.  Random
+// particles are moved a few times, most by less than a fine cell, so
+// they go to neighbor processors, and some by a quarter of the domain, so
+// they don't.  After each Redistribute() the number of particles, a
+// checksum of their (id, cpu) pairs and their mass must be unchanged, and
+// every particle must be on the level and grid Where() finds for it, on a
+// grid we own.
+//
+// Run with particles.neighbor_redistribute = 0 to check the global
+// exchange alone.  Build with USE_PARTICLES=TRUE.
+//
+
+#include <winstd.H>
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+#include <BoxLib.H>
+#include <ParmParse.H>
+#include <Geometry.H>
+#include <Particles.H>
+
+namespace
+{
+    typedef ParticleContainer<1> PC;
+    //
+    // A pseudo-random number in [-1,1) that depends on the particle, the
+    // step and the direction only, so it's the same on any number of
+    // processors.
+    //
+    Real
+    hash (int id, int step, int d)
+    {
+        const Real x = std::sin(12.9898*id + 78.233*step + 37.719*d) * 43758.5453;
+
+        return 2*(x - std::floor(x)) - 1;
+    }
+
+    void
+    move (PC& pc, int step, Real dx_fine, Real jump)
+    {
+        for (int lev = 0; lev <= pc.GetParGDB()->finestLevel(); lev++)
+        {
+            PC::PMap& pmap = pc.GetParticles(lev);
+
+            for (PC::PMap::iterator it = pmap.begin(); it != pmap.end(); ++it)
+            {
+                PC::PBox& pbox = it->second;
+
+                for (PC::PBox::iterator p = pbox.begin(); p != pbox.end(); ++p)
+                {
+                    if (p->m_id <= 0) continue;
+
+                    const bool far = (p->m_id + step) % 16 == 0;
+
+                    for (int d = 0; d < BL_SPACEDIM; d++)
+                        p->m_pos[d] += far ? jump : 0.9*dx_fine*hash(p->m_id,step,d);
+                }
+            }
+        }
+    }
+    //
+    // Number of particles not where Where() puts them or not on our grids,
+    // and a checksum of the (id, cpu) pairs of all particles.
+    //
+    long
+    count_misplaced (const PC& pc, long& idsum)
+    {
+        const ParGDBBase* gdb = pc.GetParGDB();
+
+        long nbad = 0;
+
+        idsum = 0;
+
+        for (int lev = 0; lev <= gdb->finestLevel(); lev++)
+        {
+            const PC::PMap& pmap = pc.GetParticles(lev);
+
+            for (PC::PMap::const_iterator it = pmap.begin(); it != pmap.end(); ++it)
+            {
+                const PC::PBox& pbox = it->second;
+
+                for (PC::PBox::const_iterator p = pbox.begin(); p != pbox.end(); ++p)
+                {
+                    if (p->m_id <= 0) continue;
+
+                    idsum += p->m_id + 1000003L*p->m_cpu;
+
+                    ParticleBase q = *p;
+
+                    if (!ParticleBase::Where(q, gdb) ||
+                        q.m_lev != lev || q.m_grid != it->first || p->m_grid != it->first ||
+                        gdb->ParticleDistributionMap(lev)[it->first] != ParallelDescriptor::MyProc())
+                    {
+                        ++nbad;
+                    }
+                }
+            }
+        }
+
+        ParallelDescriptor::ReduceLongSum(nbad);
+        ParallelDescriptor::ReduceLongSum(idsum);
+
+        return nbad;
+    }
+}
+
+int
+main (int argc, char* argv[])
+{
+    BoxLib::Initialize(argc,argv);
+
+    int  n_cell   = 32;
+    int  max_grid = 8;
+    long nparts   = 20000;
+    int  nsteps   = 4;
+
+    ParmParse pp;
+
+    pp.query("n_cell",   n_cell);
+    pp.query("max_grid", max_grid);
+    pp.query("nparts",   nparts);
+    pp.query("nsteps",   nsteps);
+
+    int nfail = 0;
+
+    {
+        const int rr = 2;
+
+        RealBox rb;
+        int     is_per[BL_SPACEDIM];
+
+        for (int d = 0; d < BL_SPACEDIM; d++)
+        {
+            rb.setLo(d, 0.0);
+            rb.setHi(d, 1.0);
+            is_per[d] = 1;
+        }
+
+        const Box domain(IntVect::TheZeroVector(), IntVect(D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+
+        Array<Geometry>            geoms(2);
+        Array<BoxArray>            bas(2);
+        Array<DistributionMapping> dms(2);
+        Array<int>                 rrs(1, rr);
+
+        geoms[0].define(domain, &rb, 0, is_per);
+        geoms[1].define(BoxLib::refine(domain, rr), &rb, 0, is_per);
+
+        bas[0].define(domain);
+        bas[0].maxSize(max_grid);
+
+        Box fine = BoxLib::refine(domain, rr);
+        fine.grow(-domain.length(0)/2);
+
+        bas[1].define(fine);
+        bas[1].maxSize(max_grid);
+
+        for (int lev = 0; lev < 2; lev++)
+            dms[lev].define(bas[lev], ParallelDescriptor::NProcs());
+
+        PC pc(geoms, dms, bas, rrs);
+
+        pc.InitRandom(nparts, 451, 1.0e-3);
+
+        pc.Redistribute();
+
+        const long np0   = pc.TotalNumberOfParticles();
+        const Real mass0 = pc.sumParticleMass(0) + pc.sumParticleMass(1);
+
+        long idsum0 = 0;
+
+        if (count_misplaced(pc, idsum0) > 0) ++nfail;
+
+        const Real dx_fine = geoms[1].CellSize(0);
+
+        for (int step = 1; step <= nsteps; step++)
+        {
+            move(pc, step, dx_fine, 0.25);
+            //
+            // Particles may have crossed the periodic boundary.
+            //
+            pc.Redistribute(false, true);
+
+            long       idsum = 0;
+            const long nbad  = count_misplaced(pc, idsum);
+            const long np    = pc.TotalNumberOfParticles();
+            const long np1   = pc.NumberOfParticlesAtLevel(1);
+            const Real mass  = pc.sumParticleMass(0) + pc.sumParticleMass(1);
+
+            if (ParallelDescriptor::IOProcessor())
+                std::cout << "step " << step << ": particles " << np << " of " << np0
+                          << " (" << np1 << " on level 1)"
+                          << ", id sum " << idsum << " of " << idsum0
+                          << ", mass " << std::setprecision(15) << mass << " of " << mass0
+                          << ", " << nbad << " misplaced\n";
+
+            if (np != np0 || idsum != idsum0 || nbad > 0 ||
+                std::fabs(mass - mass0) > 1.e-12*mass0)
+                ++nfail;
+        }
+    }
+
+    if (ParallelDescriptor::IOProcessor())
+        std::cout << (nfail == 0 ? "PASSED" : "FAILED") << std::endl;
+
+    BoxLib::Finalize();
+
+    return nfail == 0 ? 0 : 1;
+}
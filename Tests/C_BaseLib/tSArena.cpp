@@ -0,0 +1,186 @@
+//
+// Checks SArena, the size-class allocator behind the FAB memory pool.
+// Every OpenMP thread allocates blocks of many sizes, small and big, and
+// fills them with its own pattern; then each thread frees the blocks of
+// another thread and all threads allocate the same blocks again.  The
+// patterns must survive, freed blocks must be reused rather than new
+// hunks taken, and the statistics must add up: nothing in use at the end,
+// a high-water mark at least as large as what was in use, and a
+// fragmentation of one once everything is freed.  This is done once with
+// a cache per thread and once with all but one thread sharing a cache.
+//
+// Build with USE_OMP=TRUE to test more than one thread.
+//
+
+#include <winstd.H>
+#include <iostream>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <SArena.H>
+
+namespace
+{
+    const int nblocks = 2000;
+
+    int
+    thread_num ()
+    {
+#ifdef _OPENMP
+        return omp_get_thread_num();
+#else
+        return 0;
+#endif
+    }
+
+    int
+    num_threads ()
+    {
+#ifdef _OPENMP
+        return omp_get_max_threads();
+#else
+        return 1;
+#endif
+    }
+    //
+    // The size of block i of thread t: mostly small, some bigger than a
+    // quarter of a hunk.
+    //
+    size_t
+    block_size (int t, int i)
+    {
+        const unsigned long r = (1103515245UL*(t*nblocks+i) + 12345UL) % 2147483648UL;
+
+        return (i % 50 == 0) ? 300000 + r % 100000 : 1 + r % 5000;
+    }
+
+    unsigned char
+    pattern (int t, int i)
+    {
+        return static_cast<unsigned char>(31*t + 7*i + 1);
+    }
+
+    void
+    fill (std::vector<unsigned char*>& p, SArena& arena, int t)
+    {
+        for (int i = 0; i < nblocks; ++i)
+        {
+            const size_t n = block_size(t,i);
+
+            p[i] = static_cast<unsigned char*>(arena.alloc(n));
+
+            for (size_t k = 0; k < n; ++k)
+                p[i][k] = pattern(t,i);
+        }
+    }
+
+    long
+    count_bad (const std::vector<unsigned char*>& p, int t)
+    {
+        long nbad = 0;
+
+        for (int i = 0; i < nblocks; ++i)
+        {
+            const size_t n = block_size(t,i);
+
+            for (size_t k = 0; k < n; ++k)
+                if (p[i][k] != pattern(t,i))
+                    ++nbad;
+        }
+
+        return nbad;
+    }
+
+    void
+    release (std::vector<unsigned char*>& p, SArena& arena)
+    {
+        for (int i = 0; i < nblocks; ++i)
+            arena.free(p[i]);
+    }
+
+    bool
+    run (int ncaches)
+    {
+        const int nthreads = num_threads();
+
+        SArena arena(1024*1024, ncaches);
+
+        std::vector< std::vector<unsigned char*> > blocks(nthreads, std::vector<unsigned char*>(nblocks));
+
+        long nbad = 0, requested = 0;
+
+        for (int t = 0; t < nthreads; ++t)
+            for (int i = 0; i < nblocks; ++i)
+                requested += block_size(t,i);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        fill(blocks[thread_num()], arena, thread_num());
+
+        const long inuse = arena.heap_space_actually_used();
+        const long hwm   = arena.heap_space_hwm();
+
+        for (int t = 0; t < nthreads; ++t)
+            nbad += count_bad(blocks[t], t);
+        //
+        // Free another thread's blocks, then allocate the same again.
+        //
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        release(blocks[(thread_num()+1) % nthreads], arena);
+
+        const long heap = arena.heap_space_used();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        fill(blocks[thread_num()], arena, thread_num());
+
+        for (int t = 0; t < nthreads; ++t)
+            nbad += count_bad(blocks[t], t);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        release(blocks[thread_num()], arena);
+
+        const long   heap_again = arena.heap_space_used();
+        const long   inuse_end  = arena.heap_space_actually_used();
+        const double frag       = arena.fragmentation();
+
+        const bool ok = nbad == 0           &&
+                        inuse >= requested  &&
+                        hwm   >= inuse      &&
+                        heap_again == heap  &&
+                        inuse_end  == 0     &&
+                        frag       == 1.0;
+
+        std::cout << ncaches << " cache(s), " << nthreads << " thread(s): "
+                  << nbad << " bad bytes, "
+                  << inuse << " bytes in use for " << requested << " requested, "
+                  << "high-water mark " << hwm << ", "
+                  << "heap " << heap << " then " << heap_again << ", "
+                  << inuse_end << " bytes in use at the end, "
+                  << "fragmentation " << frag
+                  << (ok ? "" : "  FAILED") << '\n';
+
+        return ok;
+    }
+}
+
+int
+main ()
+{
+    bool ok = run(num_threads());
+
+    ok = run(1) && ok;
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,336 @@
+//
+// Checks SoAParticleContainer against ParticleContainer: both are given
+// the same random particles, which are deposited, moved and redistributed
+// a few times.  The densities (weighted by the velocities too) and the
+// particle counts must agree.  The moves alternate between a kick-drift in
+// a cell-centered gravity and a push with a face-centered umac.  The SoA
+// nodal density is checked against a direct deposit onto the periodic
+// domain, and the SoA multi-level density against the AoS one on a grid
+// hierarchy with a refined patch.
+//
+// Build with USE_PARTICLES=TRUE.
+//
+
+#include <winstd.H>
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+#include <BoxLib.H>
+#include <ParmParse.H>
+#include <MultiFab.H>
+#include <Geometry.H>
+#include <Particles.H>
+#include <SoAParticles.H>
+
+namespace
+{
+    const int NR = BL_SPACEDIM+1;  // mass and velocity
+
+    Real
+    max_diff (const MultiFab& a, const MultiFab& b)
+    {
+        MultiFab diff(a.boxArray(), a.nComp(), 0, a.DistributionMap());
+        diff.copy(b);
+        MultiFab::Subtract(diff, a, 0, 0, a.nComp(), 0);
+        Real r = 0;
+        for (int n = 0; n < a.nComp(); ++n)
+            r = std::max(r, diff.norm0(n));
+        return r;
+    }
+    //
+    // A smooth periodic field, evaluated at the cell centers or faces of mf.
+    //
+    void
+    fill_wave (MultiFab& mf, const Geometry& geom)
+    {
+        const Real* plo = geom.ProbLo();
+        const Real* dx  = geom.CellSize();
+
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        {
+            FArrayBox& fab = mf[mfi];
+            const Box& bx  = fab.box();
+
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+            {
+                Real arg = 0;
+                for (int d = 0; d < BL_SPACEDIM; ++d)
+                {
+                    const Real x = plo[d] + (iv[d] + (bx.type(d) == IndexType::NODE ? 0 : 0.5)) * dx[d];
+                    arg += (d+1) * x;
+                }
+                for (int n = 0; n < mf.nComp(); ++n)
+                    fab(iv,n) = 0.5 * std::sin(2*M_PI*arg + n);
+            }
+        }
+    }
+    //
+    // The nodal density of the SoA particles computed directly on a
+    // domain-sized periodic array, compared with AssignNodalDensitySingleLevel.
+    //
+    Real
+    nodal_diff (const SoAParticleContainer<NR>& soa, const Geometry& geom, int n_cell, Real& rmax)
+    {
+        const Real* plo = geom.ProbLo();
+        const Real* dx  = geom.CellSize();
+        const Real  vol = D_TERM(dx[0], *dx[1], *dx[2]);
+        const int   M   = D_TERM(2,*2,*2);
+
+        long npts = 1;
+        for (int d = 0; d < BL_SPACEDIM; ++d)
+            npts *= n_cell;
+
+        Array<Real> rho(npts, 0);
+
+        typedef SoAParticleContainer<NR>::TileMap TileMap;
+
+        const TileMap& tmap = soa.GetTiles(0);
+
+        for (TileMap::const_iterator it = tmap.begin(); it != tmap.end(); ++it)
+        {
+            const ParticleTile<NR>& tile = it->second;
+
+            for (int i = 0; i < tile.size(); ++i)
+            {
+                if (tile.m_id[i] <= 0) continue;
+
+                int  clo[BL_SPACEDIM];
+                Real fr[BL_SPACEDIM];
+                for (int d = 0; d < BL_SPACEDIM; ++d)
+                {
+                    const Real len = (tile.m_pos[d][i] - plo[d]) / dx[d];
+                    clo[d] = int(std::floor(len));
+                    fr[d]  = len - clo[d];
+                }
+                for (int k = 0; k < M; ++k)
+                {
+                    Real w   = tile.m_data[0][i];
+                    long idx = 0;
+                    for (int d = BL_SPACEDIM-1; d >= 0; --d)
+                    {
+                        const int s = (k >> d) & 1;
+                        w  *= s ? fr[d] : 1 - fr[d];
+                        idx = idx * n_cell + ((clo[d] + s) % n_cell + n_cell) % n_cell;
+                    }
+                    rho[idx] += w / vol;
+                }
+            }
+        }
+
+        ParallelDescriptor::ReduceRealSum(rho.dataPtr(), npts);
+
+        BoxArray nba(soa.GetParGDB()->ParticleBoxArray(0));
+        nba.surroundingNodes();
+
+        MultiFab rho_nd(nba, 1, 0);
+
+        soa.AssignNodalDensitySingleLevel(rho_nd, 0);
+
+        Real r = 0;
+        rmax   = 0;
+
+        for (MFIter mfi(rho_nd); mfi.isValid(); ++mfi)
+        {
+            const FArrayBox& fab = rho_nd[mfi];
+            const Box&       bx  = fab.box();
+
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+            {
+                long idx = 0;
+                for (int d = BL_SPACEDIM-1; d >= 0; --d)
+                    idx = idx * n_cell + iv[d] % n_cell;
+                r    = std::max(r, std::fabs(fab(iv) - rho[idx]));
+                rmax = std::max(rmax, rho[idx]);
+            }
+        }
+
+        ParallelDescriptor::ReduceRealMax(r);
+        ParallelDescriptor::ReduceRealMax(rmax);
+
+        return r;
+    }
+    //
+    // Deposits the particles on a two-level hierarchy whose fine level
+    // covers the middle of the domain.
+    //
+    bool
+    check_multilevel (const Geometry& geom, const BoxArray& ba, const DistributionMapping& dm,
+                      long nparts, int max_grid)
+    {
+        const int rr = 2;
+
+        Array<Geometry>            geoms(2);
+        Array<BoxArray>            bas(2);
+        Array<DistributionMapping> dms(2);
+        Array<int>                 rrs(1, rr);
+
+        const Box& domain = geom.Domain();
+
+        geoms[0] = geom;
+        geoms[1].define(BoxLib::refine(domain, rr));
+        bas[0]   = ba;
+        dms[0]   = dm;
+
+        Box fine = BoxLib::refine(domain, rr);
+        fine.grow(-domain.length(0)/2);
+
+        bas[1].define(fine);
+        bas[1].maxSize(max_grid);
+        dms[1].define(bas[1], ParallelDescriptor::NProcs());
+
+        ParticleContainer<NR>    aos(geoms, dms, bas, rrs);
+        SoAParticleContainer<NR> soa(geoms, dms, bas, rrs);
+
+        aos.InitRandom(nparts, 1234, 1.0e-3);
+        soa.InitRandom(nparts, 1234, 1.0e-3);
+
+        aos.Redistribute(false, true);
+        soa.Redistribute(false, true);
+
+        PArray<MultiFab> rho_aos(PArrayManage), rho_soa(PArrayManage);
+
+        aos.AssignDensity(rho_aos, 0, 1, 1);
+        soa.AssignDensity(rho_soa, 0, 1, 1);
+
+        bool ok = rho_aos.size() == 2 && rho_soa.size() == 2 &&
+                  aos.NumberOfParticlesAtLevel(1) == soa.NumberOfParticlesAtLevel(1) &&
+                  soa.NumberOfParticlesAtLevel(1) > 0;
+
+        for (int lev = 0; ok && lev < 2; ++lev)
+        {
+            const Real rdiff = max_diff(rho_aos[lev], rho_soa[lev]);
+            const Real rmax  = rho_aos[lev].norm0();
+            const long np    = soa.NumberOfParticlesAtLevel(lev);
+
+            if (ParallelDescriptor::IOProcessor())
+                std::cout << "multilevel: level " << lev << " particles " << np
+                          << ", max density diff " << rdiff << " of " << rmax << '\n';
+
+            ok = rdiff <= 1.e-10*rmax;
+        }
+
+        return ok;
+    }
+}
+
+int
+main (int argc, char* argv[])
+{
+    BoxLib::Initialize(argc,argv);
+
+    int  n_cell   = 32;
+    int  max_grid = 16;
+    long nparts   = 100000;
+    int  nsteps   = 4;
+
+    ParmParse pp;
+
+    pp.query("n_cell",   n_cell);
+    pp.query("max_grid", max_grid);
+    pp.query("nparts",   nparts);
+    pp.query("nsteps",   nsteps);
+
+    RealBox rb;
+    for (int d = 0; d < BL_SPACEDIM; ++d)
+    {
+        rb.setLo(d,0.0);
+        rb.setHi(d,1.0);
+    }
+    int is_per[BL_SPACEDIM];
+    for (int d = 0; d < BL_SPACEDIM; ++d)
+        is_per[d] = 1;
+
+    const Box domain(IntVect::TheZeroVector(), IntVect(D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+
+    Geometry geom(domain, &rb, 0, is_per);
+
+    BoxArray ba(domain);
+    ba.maxSize(max_grid);
+
+    DistributionMapping dm(ba, ParallelDescriptor::NProcs());
+
+    ParticleContainer<NR>    aos(geom, dm, ba);
+    SoAParticleContainer<NR> soa(geom, dm, ba);
+
+    const unsigned long seed = 451;
+    const Real          mass = 1.0e-3;
+
+    aos.InitRandom(nparts, seed, mass);
+    soa.InitRandom(nparts, seed, mass);
+
+    MultiFab rho_aos(ba, NR, 1), rho_soa(ba, NR, 1);
+    MultiFab grav(ba, BL_SPACEDIM, 2);
+
+    fill_wave(grav, geom);
+
+    MultiFab umac[BL_SPACEDIM];
+
+    for (int d = 0; d < BL_SPACEDIM; ++d)
+    {
+        umac[d].define(ba, 1, 2, Fab_allocate, IntVect::TheDimensionVector(d));
+        fill_wave(umac[d], geom);
+    }
+
+    const Real dt = 0.25 / n_cell;
+
+    bool ok = true;
+
+    for (int step = 0; step <= nsteps; ++step)
+    {
+        rho_aos.setVal(0);
+        rho_soa.setVal(0);
+
+        aos.AssignDensitySingleLevel(rho_aos, 0, NR);
+        soa.AssignDensitySingleLevel(rho_soa, 0, NR);
+
+        Real       ndmax = 0;
+        const Real ndiff = nodal_diff(soa, geom, n_cell, ndmax);
+        const Real rdiff = max_diff(rho_aos, rho_soa);
+        const Real rmax  = rho_aos.norm0();
+        const long naos  = aos.TotalNumberOfParticles();
+        const long nsoa  = soa.TotalNumberOfParticles();
+        const Real maos  = aos.sumParticleMass(0);
+        const Real msoa  = soa.sumParticleMass(0);
+
+        const bool step_ok = naos == nsoa && rdiff <= 1.e-10*rmax && ndiff <= 1.e-10*ndmax &&
+                             std::fabs(maos-msoa) <= 1.e-10*maos;
+
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "step " << step
+                      << ": particles " << naos << " " << nsoa
+                      << ", mass " << std::setprecision(15) << maos << " " << msoa
+                      << ", max density diff " << rdiff << " of " << rmax
+                      << ", max nodal diff " << ndiff << " of " << ndmax
+                      << (step_ok ? "" : "  FAILED") << '\n';
+
+        ok = ok && step_ok;
+
+        if (step == nsteps) break;
+
+        if (step % 2 == 0)
+        {
+            aos.moveKickDrift(grav, 0, dt);
+            soa.moveKickDrift(grav, 0, dt);
+        }
+        else
+        {
+            aos.AdvectWithUmac(umac, 0, dt, 1);
+            soa.AdvectWithUmac(umac, 0, dt, 1);
+        }
+        //
+        // Particles may have drifted across the periodic boundary.
+        //
+        aos.Redistribute(false, true);
+        soa.Redistribute(false, true);
+    }
+
+    ok = check_multilevel(geom, ba, dm, nparts, max_grid) && ok;
+
+    if (ParallelDescriptor::IOProcessor())
+        std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+
+    BoxLib::Finalize();
+
+    return ok ? 0 : 1;
+}
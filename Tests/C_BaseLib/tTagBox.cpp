@@ -0,0 +1,164 @@
+//
+// Checks TagBoxArray::collateLocal(), the tag collation used by Amr's
+// distributed clustering (amr.distributed_clustering = 1).  Cells are
+// tagged in the valid and ghost cells of each box.  Every tag returned by
+// collate() must be returned by exactly one CPU's collateLocal(), the owned
+// regions must be disjoint, and clustering the local tags within the owned
+// region, as Amr::grid_places() does, must give disjoint boxes covering
+// every tag.
+//
+// Needs TagBox.cpp and Cluster.cpp from C_AMRLib.
+//
+
+#include <winstd.H>
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#include <BoxLib.H>
+#include <ParmParse.H>
+#include <BoxDomain.H>
+#include <TagBox.H>
+#include <Cluster.H>
+
+namespace
+{
+    //
+    // Adds one to the cells of the domain covered by bx.
+    //
+    void
+    mark (std::vector<int>& cnt, const Box& domain, const Box& bx)
+    {
+        const Box isect = bx & domain;
+
+        if (!isect.ok()) return;
+
+        for (IntVect iv = isect.smallEnd(); iv <= isect.bigEnd(); isect.next(iv))
+            cnt[domain.index(iv)]++;
+    }
+}
+
+int
+main (int argc, char* argv[])
+{
+    BoxLib::Initialize(argc,argv);
+
+    int  n_cell   = 32;
+    int  max_grid = 8;
+    int  n_grow   = 2;
+    Real grid_eff = 0.7;
+
+    ParmParse pp;
+
+    pp.query("n_cell",   n_cell);
+    pp.query("max_grid", max_grid);
+    pp.query("n_grow",   n_grow);
+    pp.query("grid_eff", grid_eff);
+
+    const Box domain(IntVect::TheZeroVector(), IntVect(D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+
+    BoxArray ba(domain);
+    ba.maxSize(max_grid);
+
+    TagBoxArray tags(ba, n_grow);
+    //
+    // Tag a shell, including the ghost cells that lie in the domain, so
+    // that neighboring boxes see the same tags.  Also tag a sparse pattern
+    // that only the ghost cells see, like the buffer cells added around
+    // the tags of a neighboring box.
+    //
+    const Real c = 0.5 * n_cell, r = 0.3 * n_cell;
+
+    for (MFIter mfi(tags); mfi.isValid(); ++mfi)
+    {
+        TagBox&   tb = tags[mfi];
+        const Box bx = tb.box() & domain;
+
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+        {
+            Real d2 = 0;
+            for (int d = 0; d < BL_SPACEDIM; ++d)
+                d2 += (iv[d] + 0.5 - c) * (iv[d] + 0.5 - c);
+
+            if (std::fabs(std::sqrt(d2) - r) < 1.5)
+                tb(iv) = TagBox::SET;
+
+            if (!mfi.validbox().contains(iv) && (D_TERM(iv[0],+iv[1],+iv[2])) % 7 == 0)
+                tb(iv) = TagBox::BUF;
+        }
+    }
+
+    const long npts = domain.numPts();
+
+    std::vector<int> ref(npts,0), got(npts,0), own(npts,0), cov(npts,0);
+    //
+    // collate() gives every CPU all the tags.
+    //
+    long     nref = 0;
+    IntVect* rpts = tags.collate(nref);
+
+    for (long i = 0; i < nref; ++i)
+        ref[domain.index(rpts[i])] = 1;
+
+    delete [] rpts;
+
+    long     nloc = 0;
+    BoxList  region;
+    IntVect* lpts = tags.collateLocal(nloc, region);
+
+    for (long i = 0; i < nloc; ++i)
+        got[domain.index(lpts[i])]++;
+
+    for (BoxList::const_iterator it = region.begin(); it != region.end(); ++it)
+        mark(own, domain, *it);
+    //
+    // Cluster the local tags within the owned region.
+    //
+    BoxList new_bx;
+
+    if (nloc > 0)
+    {
+        ClusterList clist(lpts, nloc);
+        clist.chop(grid_eff);
+        BoxDomain bd;
+        bd.add(region);
+        clist.intersect(bd);
+        clist.boxList(new_bx);
+    }
+
+    delete [] lpts;
+
+    for (BoxList::const_iterator it = new_bx.begin(); it != new_bx.end(); ++it)
+        mark(cov, domain, *it);
+
+    ParallelDescriptor::ReduceIntSum(&got[0], npts);
+    ParallelDescriptor::ReduceIntSum(&own[0], npts);
+    ParallelDescriptor::ReduceIntSum(&cov[0], npts);
+
+    long ntags = 0, nmissing = 0, ndup = 0, noverlap = 0, nuncovered = 0;
+
+    for (long i = 0; i < npts; ++i)
+    {
+        ntags += ref[i];
+        if (ref[i] != std::min(got[i],1)) nmissing++;
+        if (got[i] > 1)                   ndup++;
+        if (own[i] > 1 || cov[i] > 1)     noverlap++;
+        if (ref[i] && cov[i] == 0)        nuncovered++;
+    }
+
+    const bool ok = ntags > 0 && nmissing == 0 && ndup == 0 && noverlap == 0 && nuncovered == 0;
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        std::cout << "tags " << ntags
+                  << ", missing or extra " << nmissing
+                  << ", duplicated " << ndup
+                  << ", overlapping cells " << noverlap
+                  << ", tags outside the clusters " << nuncovered << '\n';
+        std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+    }
+
+    BoxLib::Finalize();
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+//
+// Checks VisMF's asynchronous writes (amr.async_output = 1).  A MultiFab
+// is written with VisMF::SetAsyncWrite(true) into 1, 2 and NProcs data
+// files, all before waiting, and is overwritten as soon as each Write()
+// returns.  After VisMF::AsyncWait() every file must read back with the
+// data as it was when written.  This also checks that the background
+// writer thread links and runs.
+//
+
+#include <winstd.H>
+#include <iostream>
+#include <sstream>
+
+#include <BoxLib.H>
+#include <ParmParse.H>
+#include <MultiFab.H>
+#include <VisMF.H>
+
+namespace
+{
+    const int ncomp = 2;
+
+    Real
+    value (const IntVect& iv, int n, int version)
+    {
+        return D_TERM(iv[0], + 100*iv[1], + 10000*iv[2]) + 0.25*n + 1000000*version;
+    }
+
+    void
+    set_values (MultiFab& mf, int version)
+    {
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        {
+            FArrayBox& fab = mf[mfi];
+            const Box& bx  = fab.box();
+
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+                for (int n = 0; n < ncomp; ++n)
+                    fab(iv,n) = value(iv,n,version);
+        }
+    }
+    //
+    // Number of values read back from name that aren't those of version.
+    //
+    int
+    check (const std::string& name, int version)
+    {
+        int nbad = 0;
+
+        MultiFab rmf;
+
+        VisMF::Read(rmf, name);
+
+        for (MFIter mfi(rmf); mfi.isValid(); ++mfi)
+        {
+            const FArrayBox& fab = rmf[mfi];
+            const Box&       bx  = mfi.validbox();
+
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+                for (int n = 0; n < ncomp; ++n)
+                    if (fab(iv,n) != value(iv,n,version))
+                        ++nbad;
+        }
+
+        ParallelDescriptor::ReduceIntSum(nbad);
+
+        return nbad;
+    }
+}
+
+int
+main (int argc, char* argv[])
+{
+    BoxLib::Initialize(argc,argv);
+
+    int n_cell   = 32;
+    int max_grid = 8;
+
+    ParmParse pp;
+
+    pp.query("n_cell",   n_cell);
+    pp.query("max_grid", max_grid);
+
+    const Box domain(IntVect::TheZeroVector(), IntVect(D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+
+    BoxArray ba(domain);
+    ba.maxSize(max_grid);
+
+    MultiFab mf(ba, ncomp, 1);
+
+    const int nfiles[] = { 1, 2, ParallelDescriptor::NProcs() };
+    const int ntests   = sizeof(nfiles) / sizeof(nfiles[0]);
+
+    std::string names[ntests];
+
+    VisMF::SetAsyncWrite(true);
+
+    for (int i = 0; i < ntests; ++i)
+    {
+        std::ostringstream os;
+        os << "tVisMFAsync_mf_" << i;
+        names[i] = os.str();
+
+        set_values(mf, i);
+
+        VisMF::SetNOutFiles(nfiles[i]);
+
+        VisMF::Write(mf, names[i]);
+    }
+    //
+    // The staged data must not change with the MultiFab.
+    //
+    set_values(mf, ntests);
+
+    int ok = VisMF::AsyncWait();
+
+    ParallelDescriptor::ReduceIntMin(ok);
+
+    ParallelDescriptor::Barrier();
+
+    VisMF::SetAsyncWrite(false);
+
+    int nfail = ok ? 0 : 1;
+
+    for (int i = 0; i < ntests; ++i)
+    {
+        const int nbad = check(names[i], i);
+
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "nOutFiles = " << nfiles[i] << ": " << nbad << " bad values\n";
+
+        if (nbad > 0) ++nfail;
+    }
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        if (!ok) std::cout << "VisMF::AsyncWait() reported a failed write\n";
+
+        std::cout << (nfail == 0 ? "PASSED" : "FAILED") << std::endl;
+    }
+
+    BoxLib::Finalize();
+
+    return nfail == 0 ? 0 : 1;
+}
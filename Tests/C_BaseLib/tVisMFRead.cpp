@@ -0,0 +1,172 @@
+//
+// Writes a MultiFab with VisMF and reads it back with every combination
+// of vismf.parallel_read and vismf.use_mmap, through VisMF::Read(), the
+// lazy VisMF reader and VisMF::fillFab().  The data must come back as
+// written.
+//
+// Run on several CPUs, optionally with vismf.parallel_read=1 and/or
+// vismf.use_mmap=1 to check that the lazy reader picks those up.
+//
+
+#include <winstd.H>
+#include <iostream>
+
+#include <BoxLib.H>
+#include <ParmParse.H>
+#include <MultiFab.H>
+#include <VisMF.H>
+
+namespace
+{
+    const int ncomp = 3;
+
+    Real
+    value (const IntVect& iv, int n)
+    {
+        return D_TERM(iv[0], + 100*iv[1], + 10000*iv[2]) + 0.25*n;
+    }
+
+    void
+    set_values (FArrayBox& fab)
+    {
+        const Box& bx = fab.box();
+
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+            for (int n = 0; n < fab.nComp(); ++n)
+                fab(iv,n) = value(iv,n);
+    }
+    //
+    // Number of values in fab component n over bx that aren't as written.
+    //
+    int
+    check (const FArrayBox& fab, const Box& bx, int n, int fabcomp)
+    {
+        int nbad = 0;
+
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+            if (fab(iv,fabcomp) != value(iv,n))
+                ++nbad;
+
+        return nbad;
+    }
+
+    int
+    check_reads (const MultiFab& mf, const std::string& name)
+    {
+        int nbad = 0;
+
+        MultiFab rmf;
+
+        VisMF::Read(rmf, name);
+
+        for (MFIter mfi(rmf); mfi.isValid(); ++mfi)
+            for (int n = 0; n < ncomp; ++n)
+                nbad += check(rmf[mfi], mfi.validbox(), n, n);
+
+        VisMF vmf(name);
+
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        {
+            for (int n = 0; n < ncomp; ++n)
+            {
+                nbad += check(vmf.GetFab(mfi.index(),n), mfi.validbox(), n, 0);
+
+                vmf.clear(mfi.index(),n);
+            }
+        }
+        //
+        // A box straddling all the grids.
+        //
+        const Box& bb = mf.boxArray().minimalBox();
+
+        Box bx(bb.smallEnd()+IntVect::TheUnitVector(), bb.bigEnd()-IntVect::TheUnitVector());
+
+        FArrayBox fab(bx,1);
+
+        for (int n = 0; n < ncomp; ++n)
+        {
+            vmf.fillFab(fab,n);
+
+            nbad += check(fab, bx, n, 0);
+        }
+
+        ParallelDescriptor::ReduceIntSum(nbad);
+
+        return nbad;
+    }
+}
+
+int
+main (int argc, char* argv[])
+{
+    BoxLib::Initialize(argc,argv);
+
+    int parallel_read = 0, use_mmap = 0;
+
+    ParmParse pp("vismf");
+
+    const bool have_pr = pp.query("parallel_read", parallel_read);
+    const bool have_mm = pp.query("use_mmap",      use_mmap);
+
+    const std::string name = "tVisMFRead_mf";
+
+    Box domain(IntVect::TheZeroVector(), IntVect(D_DECL(31,31,31)));
+
+    BoxArray ba(domain);
+
+    ba.maxSize(8);
+
+    MultiFab mf(ba, ncomp, 0);
+
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        set_values(mf[mfi]);
+
+    VisMF::Write(mf, name);
+
+    int nfail = 0;
+    //
+    // The lazy reader must pick up the inputs given when it's the first
+    // to initialize VisMF.
+    //
+    VisMF::Finalize();
+
+    VisMF::SetParallelRead(!parallel_read);
+    VisMF::SetUseMmap(!use_mmap);
+
+    {
+        VisMF vmf(name);
+
+        if ((have_pr && VisMF::GetParallelRead() != (parallel_read != 0)) ||
+            (have_mm && VisMF::GetUseMmap()      != (use_mmap      != 0)))
+        {
+            if (ParallelDescriptor::IOProcessor())
+                std::cout << "VisMF(name) ignored the vismf inputs\n";
+            ++nfail;
+        }
+    }
+
+    for (int pr = 0; pr < 2; ++pr)
+    {
+        for (int mm = 0; mm < 2; ++mm)
+        {
+            VisMF::SetParallelRead(pr);
+            VisMF::SetUseMmap(mm);
+
+            const int nbad = check_reads(mf, name);
+
+            if (ParallelDescriptor::IOProcessor())
+                std::cout << "parallel_read = " << pr
+                          << ", use_mmap = "    << mm
+                          << ": "               << nbad << " bad values\n";
+
+            if (nbad > 0) ++nfail;
+        }
+    }
+
+    if (ParallelDescriptor::IOProcessor())
+        std::cout << (nfail == 0 ? "PASSED" : "FAILED") << std::endl;
+
+    BoxLib::Finalize();
+
+    return nfail;
+}
@@ -0,0 +1,146 @@
+//
+// Checks VisMF::SharedFile writes (vismf.shared_file = 1).  A MultiFab
+// with boxes of different sizes is written in the native and the ASCII
+// formats, the latter giving FABs whose size on disk depends on the data,
+// both synchronously and with VisMF::SetAsyncWrite(true).  Each write must
+// produce a single data file, <name>_D_0000, that reads back with the
+// data as written.
+//
+
+#include <winstd.H>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+#include <BoxLib.H>
+#include <ParmParse.H>
+#include <MultiFab.H>
+#include <VisMF.H>
+
+namespace
+{
+    const int ncomp = 2;
+
+    //
+    // At most six significant digits, so that the ASCII format, which is
+    // written at the default precision, gives back the same values.
+    //
+    Real
+    value (const IntVect& iv, int n)
+    {
+        return D_TERM(iv[0], + 32*iv[1], + 1024*iv[2]) + 0.5*n;
+    }
+
+    bool
+    exists (const std::string& file)
+    {
+        std::ifstream ifs(file.c_str());
+        return ifs.good();
+    }
+    //
+    // Number of values read back from name that aren't as written.
+    //
+    int
+    check (const std::string& name)
+    {
+        int nbad = 0;
+
+        MultiFab rmf;
+
+        VisMF::Read(rmf, name);
+
+        for (MFIter mfi(rmf); mfi.isValid(); ++mfi)
+        {
+            const FArrayBox& fab = rmf[mfi];
+            const Box&       bx  = mfi.validbox();
+
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+                for (int n = 0; n < ncomp; ++n)
+                    if (fab(iv,n) != value(iv,n))
+                        ++nbad;
+        }
+
+        ParallelDescriptor::ReduceIntSum(nbad);
+
+        return nbad;
+    }
+}
+
+int
+main (int argc, char* argv[])
+{
+    BoxLib::Initialize(argc,argv);
+
+    int n_cell   = 30;
+    int max_grid = 8;
+
+    ParmParse pp;
+
+    pp.query("n_cell",   n_cell);
+    pp.query("max_grid", max_grid);
+
+    const Box domain(IntVect::TheZeroVector(), IntVect(D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+
+    BoxArray ba(domain);
+    ba.maxSize(max_grid);
+
+    MultiFab mf(ba, ncomp, 0);
+
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        FArrayBox& fab = mf[mfi];
+        const Box& bx  = fab.box();
+
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+            for (int n = 0; n < ncomp; ++n)
+                fab(iv,n) = value(iv,n);
+    }
+
+    const FABio::Format formats[] = { FABio::FAB_NATIVE, FABio::FAB_ASCII };
+    const char*         fnames[]  = { "NATIVE", "ASCII" };
+
+    int nfail = 0;
+
+    for (int f = 0; f < 2; ++f)
+    {
+        FArrayBox::setFormat(formats[f]);
+
+        for (int async = 0; async < 2; ++async)
+        {
+            std::ostringstream os;
+            os << "tVisMFShared_mf_" << fnames[f] << '_' << async;
+            const std::string name = os.str();
+
+            VisMF::SetAsyncWrite(async);
+
+            VisMF::Write(mf, name, VisMF::SharedFile);
+
+            int ok = VisMF::AsyncWait();
+
+            ParallelDescriptor::ReduceIntMin(ok);
+
+            ParallelDescriptor::Barrier();
+
+            VisMF::SetAsyncWrite(false);
+
+            const bool one_file = exists(name + "_D_0000") && !exists(name + "_D_0001");
+
+            const int nbad = check(name);
+
+            if (ParallelDescriptor::IOProcessor())
+                std::cout << fnames[f] << (async ? ", async" : "")
+                          << ": " << nbad << " bad values"
+                          << (one_file ? "" : ", not a single data file")
+                          << (ok ? "" : ", write failed") << '\n';
+
+            if (nbad > 0 || !one_file || !ok) ++nfail;
+        }
+    }
+
+    if (ParallelDescriptor::IOProcessor())
+        std::cout << (nfail == 0 ? "PASSED" : "FAILED") << std::endl;
+
+    BoxLib::Finalize();
+
+    return nfail == 0 ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+//
+// Times the coarse-to-fine Interpolaters on a single box for refinement
+// ratios 2 and 4.  The checksums let one compare the results of two builds.
+//
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+#include <BoxLib.H>
+#include <ParmParse.H>
+#include <ParallelDescriptor.H>
+#include <FArrayBox.H>
+#include <Geometry.H>
+#include <BC_TYPES.H>
+#include <Interpolater.H>
+
+namespace
+{
+    void
+    fill_crse (FArrayBox& fab)
+    {
+        const Box& bx = fab.box();
+        for (int n = 0; n < fab.nComp(); ++n)
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+            {
+                Real v = n;
+                for (int d = 0; d < BL_SPACEDIM; ++d)
+                    v += std::sin(0.37*(d+1)*iv[d]) + 0.01*iv[d];
+                //
+                // Add a few jumps so the limiters have something to do.
+                //
+                if ((iv[0]/5) % 3 == 0) v += 2.0;
+                fab(iv,n) = v;
+            }
+    }
+
+    void
+    run (const char*    name,
+         Interpolater&  interp,
+         int            n_cell,
+         int            ncomp,
+         int            ratio,
+         int            nreps,
+         bool           nodal)
+    {
+        const IntVect rr(D_DECL(ratio,ratio,ratio));
+
+        Box fine_region(IntVect::TheZeroVector(),
+                        IntVect(D_DECL(n_cell*ratio-1,n_cell*ratio-1,n_cell*ratio-1)));
+        if (nodal)
+            fine_region.surroundingNodes();
+
+        Box crse_domain(IntVect(D_DECL(-4,-4,-4)),
+                        IntVect(D_DECL(n_cell+3,n_cell+3,n_cell+3)));
+        Box fine_domain = BoxLib::refine(crse_domain,ratio);
+
+        RealBox rb;
+        for (int d = 0; d < BL_SPACEDIM; ++d)
+        {
+            rb.setLo(d,0.0);
+            rb.setHi(d,1.0);
+        }
+        Geometry crse_geom(crse_domain,&rb,0);
+        Geometry fine_geom(fine_domain,&rb,0);
+
+        FArrayBox crse(interp.CoarseBox(fine_region,rr),ncomp);
+        FArrayBox fine(fine_region,ncomp);
+        fill_crse(crse);
+
+        Array<BCRec> bcr(ncomp);
+        for (int n = 0; n < ncomp; ++n)
+            bcr[n] = BCRec(D_DECL(INT_DIR,INT_DIR,INT_DIR),
+                           D_DECL(INT_DIR,INT_DIR,INT_DIR));
+        //
+        // One untimed call to warm up the caches and the memory pool.
+        //
+        interp.interp(crse,0,fine,0,ncomp,fine_region,rr,crse_geom,fine_geom,bcr,0,0);
+
+        const Real strt = ParallelDescriptor::second();
+
+        for (int i = 0; i < nreps; ++i)
+            interp.interp(crse,0,fine,0,ncomp,fine_region,rr,crse_geom,fine_geom,bcr,0,0);
+
+        const Real t = (ParallelDescriptor::second() - strt) / nreps;
+
+        Real sum = 0;
+        for (int n = 0; n < ncomp; ++n)
+            sum += fine.sum(n);
+
+        std::cout << std::setw(22) << name
+                  << "  ratio " << ratio
+                  << "  time/call " << std::setw(12) << t
+                  << "  checksum " << std::setprecision(17) << sum
+                  << std::setprecision(6) << '\n';
+    }
+}
+
+int
+main (int argc, char* argv[])
+{
+    BoxLib::Initialize(argc,argv);
+
+    int n_cell = 32;
+    int ncomp  = 4;
+    int nreps  = 10;
+
+    ParmParse pp;
+
+    pp.query("n_cell", n_cell);
+    pp.query("ncomp",  ncomp);
+    pp.query("nreps",  nreps);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        std::cout << "n_cell = " << n_cell
+                  << ", ncomp = " << ncomp
+                  << ", nreps = " << nreps << '\n';
+
+        for (int ratio = 2; ratio <= 4; ratio *= 2)
+        {
+            run("pc_interp",            pc_interp,            n_cell, ncomp, ratio, nreps, false);
+            run("cell_cons_interp",     cell_cons_interp,     n_cell, ncomp, ratio, nreps, false);
+            run("lincc_interp",         lincc_interp,         n_cell, ncomp, ratio, nreps, false);
+            run("node_bilinear_interp", node_bilinear_interp, n_cell, ncomp, ratio, nreps, true);
+#if (BL_SPACEDIM == 2)
+            run("quadratic_interp",     quadratic_interp,     n_cell, ncomp, ratio, nreps, false);
+            run("cell_bilinear_interp", cell_bilinear_interp, n_cell, ncomp, ratio, nreps, false);
+#endif
+        }
+    }
+
+    BoxLib::Finalize();
+}
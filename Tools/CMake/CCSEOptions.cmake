@@ -157,6 +157,10 @@ if (ENABLE_MPI)
   list(APPEND CMAKE_Fortran_FLAGS "${MPI_Fortran_FLAGS}")
 endif()
 
+# VisMF's asynchronous writes (amr.async_output) use a POSIX thread.
+find_package(Threads REQUIRED)
+list(APPEND BOXLIB_EXTRA_LIBRARIES ${CMAKE_THREAD_LIBS_INIT})
+
 if (ENABLE_OpenMP)
   set(ENABLE_OMP TRUE)
   list(APPEND BL_DEFINES BL_USE_OMP)
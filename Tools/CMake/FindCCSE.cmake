@@ -252,6 +252,10 @@ else(CCSE_LIBRARIES AND CCSE_INCLUDE_DIRS AND CCSE_PERL_DIR)
 
     endif()
 
+    # cboxlib's asynchronous VisMF writes use a POSIX thread.
+    find_package(Threads REQUIRED)
+    list(APPEND CCSE_EXT_LIBRARIES ${CMAKE_THREAD_LIBS_INIT})
+
 endif(CCSE_LIBRARIES AND CCSE_INCLUDE_DIRS AND CCSE_PERL_DIR)    
 
 # Send useful message if everything is found
@@ -108,7 +108,7 @@ Adv::init (AmrLevel &old)
 
     MultiFab& S_new = get_new_data(State_Type);
 
-    FillPatch(old, S_new, 0, cur_time, State_Type, 0, NUM_STATE);
+    FillPatchFromOld(old, S_new, cur_time, State_Type, 0, NUM_STATE);
 }
 
 //
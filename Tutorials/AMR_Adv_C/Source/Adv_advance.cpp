@@ -51,8 +51,15 @@ Adv::advance (Real time,
 	}
     }
 
-    // State with ghost cells
-    MultiFab Sborder(grids, NUM_STATE, NUM_GROW);
+    // State with ghost cells, kept by the StateData from step to step
+    // in the pooled storage mode (amr.pooled_state_data)
+    MultiFab Sborder_tmp;
+    if (StateData::Pooled()) {
+	state[State_Type].allocStageData(1, NUM_GROW);
+    } else {
+	Sborder_tmp.define(grids, NUM_STATE, NUM_GROW, Fab_allocate);
+    }
+    MultiFab& Sborder = StateData::Pooled() ? state[State_Type].stageData(0) : Sborder_tmp;
     FillPatch(*this, Sborder, NUM_GROW, time, State_Type, 0, NUM_STATE);
 
 #ifdef _OPENMP
@@ -63,6 +70,9 @@ Adv::advance (Real time,
 
 	for (MFIter mfi(S_new, true); mfi.isValid(); ++mfi)
 	{
+	    // Measure the tile for amr.use_measured_cost load balancing.
+	    CostTimer cost_timer(*this, mfi);
+
 	    const Box& bx = mfi.tilebox();
 
 	    const FArrayBox& statein = Sborder[mfi];
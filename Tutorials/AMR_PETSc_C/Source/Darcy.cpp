@@ -734,13 +734,8 @@ Darcy::init (AmrLevel &old)
   setTimeLevel(cur_time,dt_old,dt_new);
 
   MultiFab& S_new = get_new_data(State_Type);
-    
-  for (FillPatchIterator fpi(old,S_new,0,cur_time,State_Type,0,NUM_STATE);
-       fpi.isValid();
-       ++fpi)
-  {
-    S_new[fpi].copy(fpi());
-  }
+
+  FillPatchFromOld(old,S_new,cur_time,State_Type,0,NUM_STATE);
 }
 
 //
@@ -1,11 +1,11 @@
-subroutine compute_flux(phi, ng_p, fluxx, fluxy, ng_f, lo, hi, dx)
+subroutine compute_flux(phi, ng_p, fluxx, fluxy, ng_f, vlo, vhi, lo, hi, dx)
 
   implicit none
 
-  integer lo(2),hi(2),ng_p,ng_f
-  double precision   phi(lo(1)-ng_p:hi(1)+ng_p,lo(2)-ng_p:hi(2)+ng_p)
-  double precision fluxx(lo(1)-ng_f:hi(1)+ng_f+1,lo(2)-ng_f:hi(2)+ng_f)
-  double precision fluxy(lo(1)-ng_f:hi(1)+ng_f,lo(2)-ng_f:hi(2)+ng_f+1)
+  integer vlo(2),vhi(2),lo(2),hi(2),ng_p,ng_f
+  double precision   phi(vlo(1)-ng_p:vhi(1)+ng_p,vlo(2)-ng_p:vhi(2)+ng_p)
+  double precision fluxx(vlo(1)-ng_f:vhi(1)+ng_f+1,vlo(2)-ng_f:vhi(2)+ng_f)
+  double precision fluxy(vlo(1)-ng_f:vhi(1)+ng_f,vlo(2)-ng_f:vhi(2)+ng_f+1)
   double precision dx
 
   ! local variables
@@ -27,13 +27,13 @@ subroutine compute_flux(phi, ng_p, fluxx, fluxy, ng_f, lo, hi, dx)
 
 end subroutine compute_flux
 
-subroutine update_phi(phiold, phinew, ng_p, fluxx, fluxy, ng_f, lo, hi, dx, dt)
+subroutine update_phi(phiold, phinew, ng_p, fluxx, fluxy, ng_f, vlo, vhi, lo, hi, dx, dt)
 
-  integer          :: lo(2), hi(2), ng_p, ng_f
-  double precision :: phiold(lo(1)-ng_p:hi(1)+ng_p,lo(2)-ng_p:hi(2)+ng_p)
-  double precision :: phinew(lo(1)-ng_p:hi(1)+ng_p,lo(2)-ng_p:hi(2)+ng_p)
-  double precision ::  fluxx(lo(1)-ng_f:hi(1)+ng_f+1,lo(2)-ng_f:hi(2)+ng_f)
-  double precision ::  fluxy(lo(1)-ng_f:hi(1)+ng_f,lo(2)-ng_f:hi(2)+ng_f+1)
+  integer          :: vlo(2), vhi(2), lo(2), hi(2), ng_p, ng_f
+  double precision :: phiold(vlo(1)-ng_p:vhi(1)+ng_p,vlo(2)-ng_p:vhi(2)+ng_p)
+  double precision :: phinew(vlo(1)-ng_p:vhi(1)+ng_p,vlo(2)-ng_p:vhi(2)+ng_p)
+  double precision ::  fluxx(vlo(1)-ng_f:vhi(1)+ng_f+1,vlo(2)-ng_f:vhi(2)+ng_f)
+  double precision ::  fluxy(vlo(1)-ng_f:vhi(1)+ng_f,vlo(2)-ng_f:vhi(2)+ng_f+1)
   double precision :: dx, dt
 
   ! local variables
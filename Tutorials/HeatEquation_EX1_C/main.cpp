@@ -36,7 +36,8 @@ extern "C"
 #if (BL_SPACEDIM == 3)   
 			  Real* fluxz,
 #endif
-   const int* ng_f, const int* lo, const int* hi, const Real* dx);
+   const int* ng_f, const int* vlo, const int* vhi,
+   const int* lo, const int* hi, const Real* dx);
   
   void FORT_UPDATE_PHI (Real* phiold, Real* phinew, const int* ng_p,
 			Real* fluxx, 
@@ -44,27 +45,25 @@ extern "C"
 #if (BL_SPACEDIM == 3)   
 			Real* fluxz,
 #endif
-			const int* ng_f, const int* lo, const int* hi, const Real* dx, const Real* dt);
+			const int* ng_f, const int* vlo, const int* vhi,
+			const int* lo, const int* hi, const Real* dx, const Real* dt);
 }
 
 static
-void advance (MultiFab* old_phi, MultiFab* new_phi, MultiFab* flux, Real* dx, Real dt, Geometry geom)
+void advance_region (MultiFab* old_phi, MultiFab* new_phi, MultiFab* flux, Real* dx, Real dt,
+                     MFOverlapIter::Region region)
 {
-  // Fill the ghost cells of each grid from the other grids
-  old_phi->FillBoundary();
-
-  // Fill periodic boundary ghost cells
-  geom.FillPeriodicBoundary(*old_phi);
-
-  int Ncomp = old_phi->nComp();
   int ng_p = old_phi->nGrow();
   int ng_f = flux->nGrow();
 
-  // Compute fluxes one grid at a time
-  for ( MFIter mfi(*old_phi); mfi.isValid(); ++mfi )
+  // The flux stencil reaches one cell, so the interior of each grid 
+  //   does not need the ghost cells of old_phi
+  for ( MFOverlapIter mfi(*old_phi,1,region); mfi.isValid(); ++mfi )
   {
-    const Box& bx = mfi.validbox();
+    const Box& vbx = mfi.validbox();
+    const Box& bx  = mfi.tilebox();
 
+    // Compute the fluxes on the faces of this part of the grid
     FORT_COMPUTE_FLUX((*old_phi)[mfi].dataPtr(),
 		      &ng_p,
 		      flux[0][mfi].dataPtr(),
@@ -72,14 +71,10 @@ void advance (MultiFab* old_phi, MultiFab* new_phi, MultiFab* flux, Real* dx, Re
 #if (BL_SPACEDIM == 3)   
 		      flux[2][mfi].dataPtr(),
 #endif
-		      &ng_f, bx.loVect(), bx.hiVect(), &(dx[0]));
-  }
-
-  // Advance the solution one grid at a time
-  for ( MFIter mfi(*old_phi); mfi.isValid(); ++mfi )
-  {
-    const Box& bx = mfi.validbox();
+		      &ng_f, vbx.loVect(), vbx.hiVect(),
+		      bx.loVect(), bx.hiVect(), &(dx[0]));
 
+    // Advance the solution on this part of the grid
     FORT_UPDATE_PHI((*old_phi)[mfi].dataPtr(),
 		    (*new_phi)[mfi].dataPtr(),
 		    &ng_p,
@@ -88,10 +83,30 @@ void advance (MultiFab* old_phi, MultiFab* new_phi, MultiFab* flux, Real* dx, Re
 #if (BL_SPACEDIM == 3)   
 		    flux[2][mfi].dataPtr(),
 #endif
-		    &ng_f, bx.loVect(), bx.hiVect(), &(dx[0]) , &dt);
+		    &ng_f, vbx.loVect(), vbx.hiVect(),
+		    bx.loVect(), bx.hiVect(), &(dx[0]) , &dt);
   }
 }
 
+static
+void advance (MultiFab* old_phi, MultiFab* new_phi, MultiFab* flux, Real* dx, Real dt, Geometry geom)
+{
+  // Start filling the ghost cells of each grid from the other grids
+  old_phi->FillBoundary_nowait();
+
+  // Advance the interior of each grid while the ghost cells are in flight
+  advance_region(old_phi, new_phi, flux, dx, dt, MFOverlapIter::InteriorRegion);
+
+  // Finish filling the ghost cells of each grid from the other grids
+  old_phi->FillBoundary_finish();
+
+  // Fill periodic boundary ghost cells
+  geom.FillPeriodicBoundary(*old_phi);
+
+  // Advance the cells next to the grid boundaries
+  advance_region(old_phi, new_phi, flux, dx, dt, MFOverlapIter::BoundaryRegion);
+}
+
 static
 Real compute_dt (Real dx)
 {